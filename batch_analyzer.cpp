@@ -0,0 +1,278 @@
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "batch_analyzer.h"
+#include "perfect_play_table.h"
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ *
+ * File for analyzing streams of positions
+ *
+ * Each line holds a board in the format the TicTacToe constructor reads,
+ * width * height characters row by row starting with the bottom row, then
+ * optionally the player to move, 'X' or 'O'. Without a player 'X' is assumed
+ * to have moved first. Empty cells can be written as '.' so lines do not
+ * have to end in spaces. For example "X.O..X...O" is a 3x3 board with 'O' to
+ * move.
+ *
+ * Each line of output is a record for the line of input in the same place:
+ *
+ *   move=2,0 score=101 depth=9 nodes=48
+ *
+ * or "move=none" when the game is already over, or "error=..." when the line
+ * could not be read. A standard 3x3 board searched to the end of the game is
+ * answered from the solved table with no nodes. With Monte Carlo tree search
+ * the depth is how deep the tree grew and the nodes are the playouts.
+ * Programs compiled with TICTACTOEAI_SEARCH_STATS add the leaves, cutoffs,
+ * table hits, deepest ply, effective branching factor and time in
+ * microseconds of each search to the record.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // A line waiting to be analyzed and where it came in the input
+  class Job
+  {
+   public:
+    uint64_t index_;
+    std::string line_;
+  };
+
+  // Collects records from the workers and hands them to the writer in input
+  // order. Workers that get more than the window ahead of the writer wait, so
+  // one slow position can not make the other records pile up without limit.
+  class OrderedOutput
+  {
+   public:
+    explicit OrderedOutput(size_t window)
+        : records_(window), ready_(window, false)
+    {
+    }
+
+    // Adds the record for a line, waiting while it is too far ahead
+    void Put(uint64_t index, std::string record)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      changed_.wait(lock, [&] { return index < written_ + records_.size(); });
+
+      records_[index % records_.size()] = std::move(record);
+      ready_[index % records_.size()] = true;
+      changed_.notify_all();
+    }
+
+    // Takes the next record in input order, waiting for it
+    //
+    // @return false once every line has been written
+    bool Take(std::string* record)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      size_t slot = written_ % records_.size();
+      changed_.wait(lock, [&] {
+        return ready_[slot] || (finished_ && written_ == total_);
+      });
+
+      if (!ready_[slot])
+        return false;
+
+      record->swap(records_[slot]);
+      ready_[slot] = false;
+      ++written_;
+      changed_.notify_all();
+      return true;
+    }
+
+    // Every line has been read, there are total records in all
+    void Finish(uint64_t total)
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      finished_ = true;
+      total_ = total;
+      changed_.notify_all();
+    }
+
+   private:
+    std::vector<std::string> records_;
+    std::vector<bool> ready_;
+    uint64_t written_ = 0;
+
+    bool finished_ = false;
+    uint64_t total_ = 0;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+  };
+}
+
+// Reads the board and player to move from a line of input
+//
+// @param line a board followed by the player to move
+// @param settings the board size
+// @param board set to the board
+// @param player set to which players turn it is, true for 'X' false for 'O'
+//
+// @return the error record for the line, empty when it was read
+std::string tictactoeai::ParseLine(const std::string& line,
+                                   const BatchSettings& settings,
+                                   tictactoe::TicTacToe* board, bool* player)
+{
+  unsigned int cells = settings.width_ * settings.height_;
+
+  std::string text = line;
+  if (!text.empty() && text.back() == '\r')
+    text.pop_back();
+
+  if (text.size() < cells)
+    return "error=expected " + std::to_string(cells) + " cells";
+
+  *board = tictactoe::TicTacToe(text.substr(0, cells).c_str(), settings.width_,
+                                settings.height_, settings.win_length_);
+
+  std::string side = text.substr(cells);
+  side.erase(0, side.find_first_not_of(" \t"));
+  side.erase(side.find_last_not_of(" \t") + 1);
+
+  if (side.empty())
+    *player = SideToMove(*board);
+  else if (side == "X" || side == "x")
+    *player = true;
+  else if (side == "O" || side == "o")
+    *player = false;
+  else
+    return "error=unknown player " + side;
+
+  return "";
+}
+
+// Analyzes a single line of input
+//
+// @param line a board followed by the player to move
+// @param settings the board size and how long to search
+// @param table transposition table to reuse, may be shared with other
+//  threads, may be NULL
+//
+// @return the record for the line, without a newline
+std::string tictactoeai::AnalyzeLine(const std::string& line,
+                                     const BatchSettings& settings,
+                                     TranspositionTable* table)
+{
+  tictactoe::TicTacToe board;
+  bool player;
+  std::string error = ParseLine(line, settings, &board, &player);
+  if (!error.empty())
+    return error;
+
+  std::ostringstream record;
+
+  if (board.IsGameOver().first)
+  {
+    record << "move=none score=" << EvaluateBoard(board) <<
+     " depth=0 nodes=0";
+    return record.str();
+  }
+
+  SearchStats stats;
+  SearchOptions options;
+  options.table_ = table;
+  options.stats_ = &stats;
+  options.engine_ = settings.engine_;
+  options.mcts_iterations_ = settings.mcts_iterations_;
+
+  SearchResult result;
+  if (settings.time_budget_.count() > 0)
+    result = MakeTimedPlacementChoice(board, settings.time_budget_, player,
+                                      options);
+  else
+    result = ChoosePlacement(board, settings.move_depth_, player, options);
+
+  record << "move=" << result.placement_.first << "," <<
+   result.placement_.second << " score=" << result.score_ << " depth=" <<
+   result.depth_ << " nodes=" << result.nodes_;
+
+  if (kSearchStatsEnabled)
+    record << " leaves=" << stats.leaves_ << " cutoffs=" << stats.cutoffs_ <<
+     " table_hits=" << stats.table_hits_ << " max_ply=" << stats.max_ply_ <<
+     " ebf=" << stats.GetEffectiveBranchingFactor() << " us=" <<
+     std::chrono::duration_cast<std::chrono::microseconds>(
+         stats.elapsed_).count();
+
+  return record.str();
+}
+
+// Analyzes every line of the input and writes a record for each one in the
+// same order
+//
+// The calling thread reads lines into a bounded queue, worker threads each
+// analyze one line at a time sharing one transposition table, and a writer
+// thread puts the records back in order.
+//
+// @param input the lines to analyze
+// @param output where to write the records
+// @param settings the board size, how long to search and how many threads
+//
+// @return the number of lines analyzed
+uint64_t tictactoeai::AnalyzeStream(std::istream& input, std::ostream& output,
+                                    const BatchSettings& settings)
+{
+  // Throws here for a bad size instead of in every worker
+  tictactoe::BoardGeometry::Get(settings.width_, settings.height_,
+                                settings.win_length_);
+
+  unsigned int threads = settings.threads_;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  size_t queue_size = std::max(1u, settings.queue_size_);
+
+  BoundedQueue<Job> jobs(queue_size);
+  OrderedOutput records(queue_size + threads);
+
+  // Positions from the same games share most of their subtrees
+  TranspositionTable table;
+  table.Resize(settings.table_megabytes_);
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; ++i)
+  {
+    workers.emplace_back([&]() {
+      Job job;
+
+      while (jobs.Pop(&job))
+        records.Put(job.index_, AnalyzeLine(job.line_, settings, &table));
+    });
+  }
+
+  std::thread writer([&]() {
+    std::string record;
+    while (records.Take(&record))
+      output << record << '\n';
+    output.flush();
+  });
+
+  uint64_t count = 0;
+  std::string line;
+  while (std::getline(input, line))
+    jobs.Push(Job{count++, line});
+
+  jobs.Close();
+  records.Finish(count);
+
+  for (unsigned int i = 0; i < workers.size(); ++i)
+    workers[i].join();
+  writer.join();
+
+  return count;
+}
@@ -0,0 +1,130 @@
+#ifndef BATCH_ANALYZER_H_
+#define BATCH_ANALYZER_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "tictactoe.h"
+#include "tictactoe_ai.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * Analyzes a stream of positions, one per line, on several threads and
+ * writes the results in the same order as the positions
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Queue that makes Push wait while it is full, so a fast producer can not
+  // get far ahead of the threads taking from it
+  template <class T>
+  class BoundedQueue
+  {
+   public:
+    explicit BoundedQueue(size_t capacity) : capacity_(capacity) {}
+
+    // Adds an item, waiting for room
+    void Push(T item)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_full_.wait(lock, [this] { return items_.size() < capacity_; });
+      items_.push_back(std::move(item));
+      not_empty_.notify_one();
+    }
+
+    // Takes the oldest item, waiting for one
+    //
+    // @return false once the queue is closed and empty
+    bool Pop(T* item)
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      not_empty_.wait(lock, [this] { return closed_ || !items_.empty(); });
+
+      if (items_.empty())
+        return false;
+
+      *item = std::move(items_.front());
+      items_.pop_front();
+      not_full_.notify_one();
+      return true;
+    }
+
+    // No more items will be pushed, Pop returns false once the rest are taken
+    void Close()
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      closed_ = true;
+      not_empty_.notify_all();
+    }
+
+   private:
+    size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable not_full_;
+    std::condition_variable not_empty_;
+  };
+
+  // Settings for analyzing a stream of positions
+  class BatchSettings
+  {
+   public:
+    // Size of every board in the stream
+    unsigned int width_ = 3;
+    unsigned int height_ = 3;
+    unsigned int win_length_ = 3;
+
+    // Moves to look ahead, used when there is no time budget
+    unsigned int move_depth_ = 9;
+
+    // Time to search each position with iterative deepening, 0 to search to
+    // move_depth_ instead
+    std::chrono::milliseconds time_budget_{0};
+
+    // Search to use, with kEngineMcts the positions get mcts_iterations_
+    // playouts each unless there is a time budget, and with kEngineProof
+    // they are proven won, lost or tied
+    SearchEngine engine_ = kEngineMinimax;
+    unsigned int mcts_iterations_ = 10000;
+
+    // Number of positions analyzed at once, 0 for one per core
+    unsigned int threads_ = 0;
+
+    // Memory of the transposition table all the threads share
+    size_t table_megabytes_ = 64;
+
+    // Most positions read ahead of the oldest result not yet written
+    unsigned int queue_size_ = 1024;
+  };
+
+  // Reads the board and player to move of a line
+  std::string ParseLine(const std::string& line,
+                        const BatchSettings& settings,
+                        tictactoe::TicTacToe* board, bool* player);
+
+  // Analyzes a single line and formats the result record
+  std::string AnalyzeLine(const std::string& line,
+                          const BatchSettings& settings,
+                          TranspositionTable* table);
+
+  // Analyzes every line of the input, writing one record per line
+  uint64_t AnalyzeStream(std::istream& input, std::ostream& output,
+                         const BatchSettings& settings);
+}
+
+#endif  // BATCH_ANALYZER_H_
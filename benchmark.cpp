@@ -0,0 +1,974 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "board_batch.h"
+#include "fixed_board.h"
+#include "game_session.h"
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ *
+ * Benchmarks for the tic-tac-toe a.i.
+ *
+ * Searches a fixed set of openings, midgames and positions near the end of
+ * the game at several depths, then times the board functions the search
+ * leans on by themselves. Every result is one line of key=value pairs so two
+ * runs can be compared with diff or a short script:
+ *
+ *   bench=search position=3x3_opening depth=9 ms=0.93 nodes=5463 ...
+ *   bench=copy_board position=15x15_midgame ns=31.2 ops_per_sec=32051282
+ *
+ * Example run: ./benchmark.out, or ./benchmark.out --quick for a shorter run.
+ * --ordering N searches with only the move ordering heuristics in N, the
+ * MoveOrderingFlags added together, so each heuristic can be measured by
+ * itself: ./benchmark.out --ordering 0 turns move ordering off.
+ *
+ * The transposition table is also hammered by several threads at once, both
+ * with raw probes and stores and with whole searches sharing one table, and
+ * every entry read back is checked so a torn entry shows up as corrupt=N.
+ *
+ * Random games on the 3x3 and 4x4 positions are played both on TicTacToe and
+ * on the FixedBoard of their size, the same games on each, to show what
+ * building the lines in when the program is compiled is worth.
+ *
+ * EvaluateBoard is checked against CalcGameScore and the scoring by blocked
+ * directions it replaced on every board of every 3x3 game.
+ *
+ * Boards played out from each position are scored one at a time with
+ * CalcGameScore and then all at once with EvaluateBatch, with each kernel
+ * the processor has.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Heap allocations made since the program started, counted by the
+  // replacement operator new below
+  std::atomic<uint64_t> allocations{0};
+  std::atomic<uint64_t> allocated_bytes{0};
+
+  // Allocates and counts memory for every form of the replacement operator
+  // new, all of which operator delete frees with std::free
+  //
+  // @param size the bytes asked for
+  // @param alignment the alignment asked for, 0 for the default
+  //
+  // @return the memory, NULL when there is none
+  void* CountedAllocate(size_t size, size_t alignment)
+  {
+    ++allocations;
+    allocated_bytes += size;
+
+    if (size == 0)
+      size = 1;
+
+    if (alignment <= alignof(std::max_align_t))
+      return std::malloc(size);
+
+    // aligned_alloc wants the size to be a multiple of the alignment
+    return std::aligned_alloc(alignment,
+                              (size + alignment - 1) / alignment * alignment);
+  }
+
+  // Allocates and counts memory for the throwing forms of operator new
+  void* CountedAllocateOrThrow(size_t size, size_t alignment)
+  {
+    if (void* memory = CountedAllocate(size, alignment))
+      return memory;
+    throw std::bad_alloc();
+  }
+
+  // A position of the corpus and the depths to search it to
+  class BenchPosition
+  {
+   public:
+    std::string name_;
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int win_length_;
+
+    // Row by row from the bottom row, '.' for an empty cell
+    std::string cells_;
+
+    bool player_;
+    std::vector<unsigned int> depths_;
+  };
+
+  // Openings, midgames and positions close to the end of the game on the
+  // board sizes the a.i. gets played on. Never change a position once it is
+  // here, add a new one instead so old runs can still be compared.
+  std::vector<BenchPosition> MakeCorpus()
+  {
+    std::vector<BenchPosition> corpus;
+
+    corpus.push_back({"3x3_opening", 3, 3, 3,
+                      ".........", true, {3, 6, 9}});
+    corpus.push_back({"3x3_midgame", 3, 3, 3,
+                      "X...O.X..", false, {3, 6}});
+    corpus.push_back({"3x3_endgame", 3, 3, 3,
+                      "XOX.OX...", false, {2, 4}});
+
+    corpus.push_back({"4x4_opening", 4, 4, 4,
+                      "................", true, {4, 6, 8}});
+    corpus.push_back({"4x4_midgame", 4, 4, 4,
+                      "X..O.XO...X..O..", true, {4, 6, 8}});
+    corpus.push_back({"4x4_endgame", 4, 4, 4,
+                      "XOXOOXOX.XO..OX.", true, {2, 4}});
+
+    std::string board_15(15 * 15, '.');
+    corpus.push_back({"15x15_opening", 15, 15, 5,
+                      board_15, true, {2, 3}});
+
+    // A cluster of tokens in the middle of the board
+    std::string midgame_15 = board_15;
+    const unsigned int cells[][3] = {
+        {7, 7, 'X'}, {8, 7, 'O'}, {7, 8, 'X'}, {6, 6, 'O'}, {8, 8, 'X'},
+        {9, 9, 'O'}, {6, 8, 'X'}, {5, 8, 'O'}, {7, 6, 'X'}, {7, 9, 'O'}};
+    for (const unsigned int* cell : cells)
+      midgame_15[cell[1] * 15 + cell[0]] = cell[2];
+    corpus.push_back({"15x15_midgame", 15, 15, 5,
+                      midgame_15, true, {2, 3}});
+
+    // 'X' has four in a row with an open end and 'O' has to block it
+    std::string endgame_15 = midgame_15;
+    endgame_15[5 * 15 + 7] = 'X';
+    corpus.push_back({"15x15_endgame", 15, 15, 5,
+                      endgame_15, false, {2, 3}});
+
+    return corpus;
+  }
+
+  // Stops the compiler from dropping work on memory nobody reads
+  void KeepAlive(const void* memory)
+  {
+    asm volatile("" : : "r"(memory) : "memory");
+  }
+
+  // Seconds since the given time
+  double SecondsSince(std::chrono::steady_clock::time_point start)
+  {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() -
+                                         start).count();
+  }
+
+  // Searches a position to a depth over and over for at least min_seconds
+  // and prints the average time, nodes and allocations of one search
+  //
+  // @param position the position to search
+  // @param depth the depth to search to
+  // @param min_seconds how long to keep searching for
+  // @param ordering the MoveOrderingFlags to search with
+  void BenchSearch(const BenchPosition& position, unsigned int depth,
+                   double min_seconds, unsigned int ordering)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+    tictactoeai::SearchOptions options;
+    options.move_ordering_ = ordering;
+
+    uint64_t searches = 0;
+    uint64_t nodes = 0;
+    uint64_t start_allocations = allocations;
+    uint64_t start_bytes = allocated_bytes;
+    tictactoeai::SearchResult result;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    do
+    {
+      result = tictactoeai::AnalyzePlacement(board, depth, position.player_,
+                                             options);
+      nodes += result.nodes_;
+      ++searches;
+    } while (SecondsSince(start) < min_seconds);
+    double seconds = SecondsSince(start);
+
+    std::cout << "bench=search position=" << position.name_ <<
+     " depth=" << depth <<
+     " ordering=" << ordering <<
+     " ms=" << seconds * 1000 / searches <<
+     " nodes=" << nodes / searches <<
+     " nodes_per_sec=" << uint64_t(nodes / seconds) <<
+     " allocations=" << (allocations - start_allocations) / searches <<
+     " allocated_bytes=" << (allocated_bytes - start_bytes) / searches <<
+     " move=" << result.placement_.first << "," << result.placement_.second <<
+     " score=" << result.score_ << std::endl;
+  }
+
+  // Runs Monte Carlo tree searches of a position over and over for at least
+  // min_seconds and prints the average time and playout rate of one search
+  //
+  // @param position the position to search
+  // @param iterations the playouts of each search
+  // @param min_seconds how long to keep searching for
+  void BenchMcts(const BenchPosition& position, unsigned int iterations,
+                 double min_seconds)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+    tictactoeai::SearchOptions options;
+    options.mcts_iterations_ = iterations;
+    tictactoeai::MctsNodePool pool;
+    options.mcts_pool_ = &pool;
+
+    uint64_t searches = 0;
+    uint64_t playouts = 0;
+    tictactoeai::SearchResult result;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    do
+    {
+      result = tictactoeai::MakeMctsPlacementChoice(board, position.player_,
+                                                    options);
+      playouts += result.nodes_;
+      ++searches;
+    } while (SecondsSince(start) < min_seconds);
+    double seconds = SecondsSince(start);
+
+    std::cout << "bench=mcts position=" << position.name_ <<
+     " iterations=" << iterations <<
+     " ms=" << seconds * 1000 / searches <<
+     " playouts=" << playouts / searches <<
+     " playouts_per_sec=" << uint64_t(playouts / seconds) <<
+     " tree_depth=" << result.depth_ <<
+     " move=" << result.placement_.first << "," << result.placement_.second <<
+     " score=" << result.score_ << std::endl;
+  }
+
+  // Plays a game out from a position with a GameSession choosing every move,
+  // then makes the same choices again with a fresh table and tree for each
+  // one, and prints the average time of a move both ways
+  //
+  // @param position the position to play from
+  // @param depth the depth to search each move to
+  // @param engine the search to choose with
+  // @param max_moves the most moves to play
+  void BenchSession(const BenchPosition& position, unsigned int depth,
+                    tictactoeai::SearchEngine engine, unsigned int max_moves)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+    tictactoeai::SearchOptions options;
+    options.engine_ = engine;
+
+    tictactoeai::GameSession session(board, position.player_, options);
+    std::vector<tictactoe::TicTacToe> boards;
+    std::vector<bool> players;
+    uint64_t kept_playouts = 0;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    while (!session.get_board().IsGameOver().first &&
+           boards.size() < max_moves)
+    {
+      boards.push_back(session.get_board());
+      players.push_back(session.get_player());
+      kept_playouts += session.get_tree_playouts();
+
+      std::pair<unsigned int, unsigned int> move = session.ChooseMove(depth);
+      session.PlayMove(move.first, move.second);
+    }
+    double session_seconds = SecondsSince(start);
+
+    start = std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < boards.size(); ++i)
+    {
+      tictactoeai::TranspositionTable table;
+      tictactoeai::SearchOptions fresh = options;
+      fresh.table_ = &table;
+      tictactoeai::MakePlacementChoice(boards[i], depth, players[i], fresh);
+    }
+    double fresh_seconds = SecondsSince(start);
+
+    unsigned int moves = std::max<size_t>(1, boards.size());
+    std::cout << "bench=session position=" << position.name_ <<
+     " engine=" << (engine == tictactoeai::kEngineMcts ? "mcts" : "minimax") <<
+     " depth=" << depth <<
+     " moves=" << boards.size() <<
+     " ms_per_move=" << session_seconds * 1000 / moves <<
+     " fresh_ms_per_move=" << fresh_seconds * 1000 / moves <<
+     " kept_playouts=" << kept_playouts / moves << std::endl;
+  }
+
+  // Entry a contention run stores for a key, worked out from the key alone
+  // so any thread can check what it reads back
+  void MakeStressEntry(uint64_t key, int* score, unsigned int* depth,
+                       unsigned short* best_move)
+  {
+    *score = int(uint32_t(key >> 32));
+    *depth = (key >> 8) & 0xff;
+    *best_move = key & 0xff;
+  }
+
+  // Prints the probe and store counts each thread made on a table
+  //
+  // @param table the table the threads used
+  // @param slots the counter slot of each thread
+  void PrintThreadCounters(const tictactoeai::TranspositionTable& table,
+                           const std::vector<unsigned int>& slots)
+  {
+    for (unsigned int i = 0; i < slots.size(); ++i)
+    {
+      tictactoeai::TableCounters counters = table.GetThreadCounters(slots[i]);
+      std::cout << "bench=table_thread thread=" << i <<
+       " probes=" << counters.hits_ + counters.misses_ <<
+       " hits=" << counters.hits_ <<
+       " stores=" << counters.stores_ <<
+       " overwrites=" << counters.overwrites_ << std::endl;
+    }
+  }
+
+  // Has several threads probe and store random keys of a small key space in
+  // one table for at least min_seconds, so they keep writing the same
+  // buckets, and checks every entry they find against its key
+  //
+  // @param threads the number of threads
+  // @param min_seconds how long to keep going for
+  void BenchTableContention(unsigned int threads, double min_seconds)
+  {
+    // Four keys for every slot so the buckets keep being replaced
+    const unsigned int kSizeBits = 14;
+    const uint64_t kKeys = uint64_t(4) << kSizeBits;
+
+    tictactoeai::TranspositionTable table(kSizeBits);
+    std::atomic<uint64_t> operations{0};
+    std::atomic<uint64_t> corrupt{0};
+    std::vector<unsigned int> slots(threads);
+    std::vector<std::thread> workers;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+      workers.emplace_back([&, i]() {
+        slots[i] = tictactoeai::TranspositionTable::GetThreadSlot();
+        uint64_t random = 0x9e3779b97f4a7c15ULL * (i + 1);
+        uint64_t count = 0;
+        uint64_t bad = 0;
+
+        do
+        {
+          for (unsigned int j = 0; j < 1024; ++j)
+          {
+            random ^= random >> 12;
+            random ^= random << 25;
+            random ^= random >> 27;
+            uint64_t mixed = random * 0x2545f4914f6cdd1dULL;
+
+            // Spread over the whole word so the index and the check bits
+            // both vary
+            uint64_t key = ((mixed >> 8) % kKeys) * 0xbf58476d1ce4e5b9ULL;
+
+            int score;
+            unsigned int depth;
+            unsigned short best_move;
+            MakeStressEntry(key, &score, &depth, &best_move);
+
+            if ((mixed & 3) == 0)
+            {
+              table.Store(key, score, depth, tictactoeai::kLowerBound,
+                          best_move);
+            }
+            else
+            {
+              tictactoeai::TableEntry entry;
+              if (table.Probe(key, &entry) &&
+                  (entry.score_ != score || entry.depth_ != depth ||
+                   entry.best_move_ != best_move ||
+                   entry.bound_ != tictactoeai::kLowerBound))
+                ++bad;
+            }
+          }
+          count += 1024;
+        } while (SecondsSince(start) < min_seconds);
+
+        operations += count;
+        corrupt += bad;
+      });
+    }
+
+    for (std::thread& worker : workers)
+      worker.join();
+    double seconds = SecondsSince(start);
+
+    tictactoeai::TableCounters counters = table.GetCounters();
+    std::cout << "bench=table_contention threads=" << threads <<
+     " ops_per_sec=" << uint64_t(operations / seconds) <<
+     " hit_rate=" << double(counters.hits_) /
+                     std::max<uint64_t>(1, counters.hits_ + counters.misses_) <<
+     " overwrites=" << counters.overwrites_ <<
+     " corrupt=" << corrupt << std::endl;
+    PrintThreadCounters(table, slots);
+  }
+
+  // Has several threads search a position over and over for at least
+  // min_seconds, all sharing one table, and checks every result against a
+  // search made alone with a table of its own
+  //
+  // @param position the position to search
+  // @param depth the depth to search to
+  // @param threads the number of threads
+  // @param min_seconds how long to keep searching for
+  void BenchSharedTable(const BenchPosition& position, unsigned int depth,
+                        unsigned int threads, double min_seconds)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+
+    tictactoeai::TranspositionTable own_table;
+    tictactoeai::SearchOptions options;
+    options.table_ = &own_table;
+    tictactoeai::SearchResult expected =
+     tictactoeai::AnalyzePlacement(board, depth, position.player_, options);
+
+    // Small so it is quick to clear, every search empties it first so the
+    // searches keep filling it together instead of reading one stored result
+    tictactoeai::TranspositionTable table(10);
+    options.table_ = &table;
+    std::atomic<uint64_t> searches{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::vector<unsigned int> slots(threads);
+    std::vector<std::thread> workers;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    for (unsigned int i = 0; i < threads; ++i)
+    {
+      workers.emplace_back([&, i]() {
+        slots[i] = tictactoeai::TranspositionTable::GetThreadSlot();
+
+        do
+        {
+          table.Clear();
+          tictactoeai::SearchResult result = tictactoeai::AnalyzePlacement(
+              board, depth, position.player_, options);
+          if (result.placement_ != expected.placement_ ||
+              result.score_ != expected.score_)
+            ++mismatches;
+          ++searches;
+        } while (SecondsSince(start) < min_seconds);
+      });
+    }
+
+    for (std::thread& worker : workers)
+      worker.join();
+    double seconds = SecondsSince(start);
+
+    std::cout << "bench=shared_table position=" << position.name_ <<
+     " depth=" << depth <<
+     " threads=" << threads <<
+     " searches_per_sec=" << uint64_t(searches / seconds) <<
+     " hit_rate=" << double(table.get_hits()) /
+                     std::max<uint64_t>(1, table.get_hits() +
+                                           table.get_misses()) <<
+     " mismatches=" << mismatches << std::endl;
+    PrintThreadCounters(table, slots);
+  }
+
+  // Runs an operation on a board over and over for at least min_seconds and
+  // prints how long one call takes
+  //
+  // @param name the name of the benchmark
+  // @param position the position to run the operation on
+  // @param min_seconds how long to keep running for
+  // @param operation the operation, returns a value so it is not optimized
+  //  away
+  template <class Operation>
+  void BenchOperation(const std::string& name, const BenchPosition& position,
+                      double min_seconds, Operation operation)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+
+    uint64_t calls = 0;
+    int64_t sink = 0;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    do
+    {
+      for (unsigned int i = 0; i < 1024; ++i)
+        sink += operation(board);
+      calls += 1024;
+    } while (SecondsSince(start) < min_seconds);
+    double seconds = SecondsSince(start);
+
+    std::cout << "bench=" << name << " position=" << position.name_ <<
+     " ns=" << seconds * 1e9 / calls <<
+     " ops_per_sec=" << uint64_t(calls / seconds) <<
+     " checksum=" << sink << std::endl;
+  }
+
+  // Plays the given games over and over for at least min_seconds, each game
+  // places tokens in the order given until one wins or the order runs out
+  // and then takes them all back off
+  //
+  // @param orders the cells of each game in the order they are played
+  // @param player which players turn it is first, true for 'X' false for 'O'
+  // @param min_seconds how long to keep playing for
+  // @param place places a token and returns whether it won
+  // @param remove takes a token back off
+  // @param wins set to the number of the games won
+  //
+  // @return the average nanoseconds of one game
+  template <class Place, class Remove>
+  double TimeGames(const std::vector<std::vector<unsigned short>>& orders,
+                   bool player, double min_seconds, Place place,
+                   Remove remove, uint64_t* wins)
+  {
+    uint64_t games = 0;
+    *wins = 0;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    do
+    {
+      for (const std::vector<unsigned short>& order : orders)
+      {
+        bool mover = player;
+        unsigned int placed = 0;
+
+        while (placed < order.size())
+        {
+          if (place(mover, order[placed++]))
+          {
+            *wins += games == 0;
+            break;
+          }
+          mover = !mover;
+        }
+
+        for (unsigned int i = 0; i < placed; ++i)
+          remove(order[i]);
+      }
+      games += orders.size();
+    } while (SecondsSince(start) < min_seconds);
+
+    return SecondsSince(start) * 1e9 / games;
+  }
+
+  // Plays random games from a position on TicTacToe and on the FixedBoard of
+  // its size and prints the average time of one game on each. Both play the
+  // same games so the number of games won has to match.
+  //
+  // @param position the position to play from, must be W by H with K in a
+  //  row
+  // @param min_seconds how long to keep playing for on each board
+  template <unsigned int W, unsigned int H, unsigned int K>
+  void BenchFixedBoard(const BenchPosition& position, double min_seconds)
+  {
+    tictactoe::TicTacToe board(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+    tictactoe::FixedBoard<W, H, K> fixed(board);
+
+    std::vector<unsigned short> empty;
+    for (unsigned int cell = 0; cell < W * H; ++cell)
+      if (board.GetCell(cell % W, cell / W) == ' ')
+        empty.push_back(cell);
+
+    std::mt19937 random(1);
+    std::vector<std::vector<unsigned short>> orders(256, empty);
+    for (std::vector<unsigned short>& order : orders)
+      std::shuffle(order.begin(), order.end(), random);
+
+    uint64_t runtime_wins = 0;
+    double runtime_ns = TimeGames(
+        orders, position.player_, min_seconds,
+        [&](bool player, unsigned int cell) {
+          board.PlaceToken(player, cell % W, cell / W);
+          return board.CheckForWin().first;
+        },
+        [&](unsigned int cell) { board.RemoveToken(cell % W, cell / W); },
+        &runtime_wins);
+
+    uint64_t fixed_wins = 0;
+    double fixed_ns = TimeGames(
+        orders, position.player_, min_seconds,
+        [&](bool player, unsigned int cell) {
+          return fixed.Place(player, cell);
+        },
+        [&](unsigned int cell) { fixed.Remove(cell); },
+        &fixed_wins);
+
+    std::cout << "bench=fixed_board position=" << position.name_ <<
+     " runtime_ns=" << runtime_ns <<
+     " fixed_ns=" << fixed_ns <<
+     " speedup=" << runtime_ns / fixed_ns <<
+     " wins=" << runtime_wins << "," << fixed_wins << std::endl;
+  }
+
+  // Scores a board the way CalcGameScore did before the board kept line
+  // counts, a point for each direction through each token that the other
+  // player has not blocked
+  //
+  // @param board the board to score
+  //
+  // @return the score of the game, positive when 'X' is winning
+  int CalcBlockedScore(const tictactoe::TicTacToe &board)
+  {
+    int score = 0;
+
+    for (unsigned int y = 0; y < board.get_height(); ++y)
+    {
+      for (unsigned int x = 0; x < board.get_width(); ++x)
+      {
+        char piece = board.GetCell(x, y);
+        if (piece == ' ')
+          continue;
+
+        int open = !tictactoeai::IsRowBlocked(board, x, y) +
+                   !tictactoeai::IsColumnBlocked(board, x, y) +
+                   !tictactoeai::IsRightDiagnolBlocked(board, x, y) +
+                   !tictactoeai::IsLeftDiagnolBlocked(board, x, y);
+        score += piece == 'X' ? open : -open;
+      }
+    }
+
+    char winner = board.CheckForWin().second;
+    if (winner == 'X')
+      score += tictactoeai::CalcWinScore(board);
+    else if (winner == 'O')
+      score -= tictactoeai::CalcWinScore(board);
+
+    return score;
+  }
+
+  // Checks EvaluateBoard on a board against CalcGameScore and the blocked
+  // direction scoring, then does the same for every game played on from it
+  //
+  // @param board the board, put back the way it was before returning
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param positions counts the boards checked
+  // @param mismatches counts the boards whose scores differ
+  void CheckEvaluation(tictactoe::TicTacToe* board, bool player,
+                       uint64_t* positions, uint64_t* mismatches)
+  {
+    int score = tictactoeai::EvaluateBoard(*board);
+
+    ++*positions;
+    if (score != tictactoeai::CalcGameScore(*board) ||
+        score != CalcBlockedScore(*board))
+      ++*mismatches;
+
+    if (board->IsGameOver().first)
+      return;
+
+    for (unsigned int y = 0; y < board->get_height(); ++y)
+    {
+      for (unsigned int x = 0; x < board->get_width(); ++x)
+      {
+        if (board->GetCell(x, y) != ' ')
+          continue;
+
+        board->PlaceToken(player, x, y);
+        CheckEvaluation(board, !player, positions, mismatches);
+        board->RemoveToken(x, y);
+      }
+    }
+  }
+
+  // Walks every game on the standard 3x3 board and checks the score the
+  // search uses on every board reached, printing how many differ
+  void BenchEvalCheck()
+  {
+    tictactoe::TicTacToe board(3, 3, 3);
+    uint64_t positions = 0;
+    uint64_t mismatches = 0;
+
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    CheckEvaluation(&board, true, &positions, &mismatches);
+
+    std::cout << "bench=eval_check positions=" << positions <<
+     " ms=" << SecondsSince(start) * 1e3 <<
+     " mismatches=" << mismatches << std::endl;
+  }
+
+  // Scores boards played out from a position one at a time with
+  // CalcGameScore, then in one batch with each kernel the processor has, and
+  // prints the average time per board of each. Every board's score and
+  // winner from every kernel is checked against CalcGameScore and
+  // CheckForWin, and the ones that differ are counted.
+  //
+  // @param position the position to play out from
+  // @param min_seconds how long to keep scoring for with each
+  void BenchBatchEval(const BenchPosition& position, double min_seconds)
+  {
+    tictactoe::TicTacToe start(position.cells_.c_str(), position.width_,
+                               position.height_, position.win_length_);
+
+    std::mt19937 random(1);
+    std::vector<tictactoe::TicTacToe> boards(1024, start);
+    tictactoeai::BoardBatch batch(start.get_geometry());
+    for (tictactoe::TicTacToe& board : boards)
+    {
+      bool player = position.player_;
+      unsigned int moves = random() % (board.get_empty_spaces() + 1);
+      for (unsigned int i = 0; i < moves && !board.IsGameOver().first; ++i)
+      {
+        unsigned int x;
+        unsigned int y;
+        do
+        {
+          x = random() % position.width_;
+          y = random() % position.height_;
+        } while (board.GetCell(x, y) != ' ');
+
+        board.PlaceToken(player, x, y);
+        player = !player;
+      }
+      batch.Add(board);
+    }
+
+    std::vector<int> expected_scores(boards.size());
+    uint64_t scored = 0;
+    std::chrono::steady_clock::time_point begin =
+     std::chrono::steady_clock::now();
+    do
+    {
+      for (size_t i = 0; i < boards.size(); ++i)
+        expected_scores[i] = tictactoeai::CalcGameScore(boards[i]);
+      KeepAlive(expected_scores.data());
+      scored += boards.size();
+    } while (SecondsSince(begin) < min_seconds);
+
+    std::cout << "bench=batch_eval position=" << position.name_ <<
+     " boards=" << boards.size() <<
+     " one_ns=" << SecondsSince(begin) * 1e9 / scored;
+
+    uint64_t mismatches = 0;
+    std::vector<int> scores(boards.size());
+    std::vector<char> winners(boards.size());
+    for (tictactoeai::BatchKernel kernel : {tictactoeai::kKernelScalar,
+                                            tictactoeai::kKernelSse,
+                                            tictactoeai::kKernelAvx2})
+    {
+      if (kernel > tictactoeai::DetectBatchKernel())
+        break;
+
+      scored = 0;
+      begin = std::chrono::steady_clock::now();
+      do
+      {
+        tictactoeai::EvaluateBatch(batch, scores.data(), winners.data(),
+                                   kernel);
+        scored += boards.size();
+      } while (SecondsSince(begin) < min_seconds);
+
+      std::cout << " " << tictactoeai::GetBatchKernelName(kernel) <<
+       "_ns=" << SecondsSince(begin) * 1e9 / scored;
+
+      for (size_t i = 0; i < boards.size(); ++i)
+        if (scores[i] != expected_scores[i] ||
+            winners[i] != boards[i].CheckForWin().second)
+          ++mismatches;
+    }
+
+    std::cout << " mismatches=" << mismatches << std::endl;
+  }
+}
+
+// The plain, array, aligned and nothrow forms are all replaced, so every
+// allocation is counted and freed by the same pair of functions
+
+void* operator new(size_t size)
+{
+  return CountedAllocateOrThrow(size, 0);
+}
+
+void* operator new[](size_t size)
+{
+  return CountedAllocateOrThrow(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment)
+{
+  return CountedAllocateOrThrow(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment)
+{
+  return CountedAllocateOrThrow(size, size_t(alignment));
+}
+
+void* operator new(size_t size, const std::nothrow_t&) noexcept
+{
+  return CountedAllocate(size, 0);
+}
+
+void* operator new[](size_t size, const std::nothrow_t&) noexcept
+{
+  return CountedAllocate(size, 0);
+}
+
+void* operator new(size_t size, std::align_val_t alignment,
+                   const std::nothrow_t&) noexcept
+{
+  return CountedAllocate(size, size_t(alignment));
+}
+
+void* operator new[](size_t size, std::align_val_t alignment,
+                     const std::nothrow_t&) noexcept
+{
+  return CountedAllocate(size, size_t(alignment));
+}
+
+void operator delete(void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, size_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, size_t, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, size_t, std::align_val_t) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete(void* memory, std::align_val_t,
+                     const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+void operator delete[](void* memory, std::align_val_t,
+                       const std::nothrow_t&) noexcept
+{
+  std::free(memory);
+}
+
+int main(int argc, char** argv)
+{
+  double min_seconds = 0.5;
+  unsigned int ordering = tictactoeai::kOrderAll;
+
+  for (int i = 1; i < argc; ++i)
+  {
+    std::string arg = argv[i];
+
+    if (arg == "--quick")
+      min_seconds = 0.05;
+    else if (arg == "--ordering" && i + 1 < argc)
+      ordering = std::strtoul(argv[++i], NULL, 10);
+    else
+    {
+      std::cerr << "Usage: " << argv[0] << " [--quick] [--ordering N]" <<
+       std::endl;
+      return 1;
+    }
+  }
+
+  std::vector<BenchPosition> corpus = MakeCorpus();
+
+  for (const BenchPosition& position : corpus)
+    for (unsigned int depth : position.depths_)
+      BenchSearch(position, depth, min_seconds, ordering);
+
+  for (const BenchPosition& position : corpus)
+    BenchMcts(position, 10000, min_seconds);
+
+  for (const BenchPosition& position : corpus)
+  {
+    if (position.width_ == 4)
+      BenchSession(position, position.depths_.back(),
+                   tictactoeai::kEngineMinimax, 16);
+    else if (position.width_ == 15)
+      BenchSession(position, 0, tictactoeai::kEngineMcts, 8);
+  }
+
+  // At least 4 threads so they interleave on the table even on one core
+  unsigned int threads = std::max(4u, std::thread::hardware_concurrency());
+  BenchTableContention(1, min_seconds);
+  BenchTableContention(threads, min_seconds);
+
+  for (const BenchPosition& position : corpus)
+    if (position.width_ == 4)
+      BenchSharedTable(position, position.depths_.back(), threads,
+                       min_seconds);
+
+  for (const BenchPosition& position : corpus)
+  {
+    if (position.width_ == 3)
+      BenchFixedBoard<3, 3, 3>(position, min_seconds);
+    else if (position.width_ == 4)
+      BenchFixedBoard<4, 4, 4>(position, min_seconds);
+  }
+
+  BenchEvalCheck();
+
+  for (const BenchPosition& position : corpus)
+    BenchBatchEval(position, min_seconds);
+
+  for (const BenchPosition& position : corpus)
+  {
+    BenchOperation("calc_game_score", position, min_seconds,
+                   [](const tictactoe::TicTacToe& board) {
+                     return tictactoeai::CalcGameScore(board);
+                   });
+
+    BenchOperation("check_for_win", position, min_seconds,
+                   [](const tictactoe::TicTacToe& board) {
+                     return int(board.CheckForWin().second);
+                   });
+
+    BenchOperation("copy_board", position, min_seconds,
+                   [](const tictactoe::TicTacToe& board) {
+                     tictactoe::TicTacToe copy(board);
+                     KeepAlive(&copy);
+                     return int(copy.get_empty_spaces());
+                   });
+  }
+}
@@ -0,0 +1,433 @@
+#include <stdexcept>
+#include <vector>
+
+#include "board_batch.h"
+#include "tictactoe_ai.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define TICTACTOEAI_X86_KERNELS 1
+#endif
+
+/******************************************************************************
+ *
+ * File for scoring boards in batches
+ *
+ * Every kernel walks the lines of the board for a group of boards at a time,
+ * the group held in one vector register for each word of the bitboards. For
+ * each line it counts the tokens of both players in it with a nibble lookup
+ * table, since neither SSE nor AVX2 can count the bits of a 64 bit lane, and
+ * adds them to the score of each board the way CalcGameScore does:
+ *
+ *   score += (o_count == 0) * x_count - (x_count == 0) * o_count
+ *
+ * The SSE and AVX2 kernels are compiled for their instructions with target
+ * attributes, so the rest of the program needs no special flags, and only
+ * run when the processor has them.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Splits the lines of a board into the words of its bitboards
+  //
+  // @param geometry the lines of the board
+  // @param word_count the words the bitboards of the board use
+  //
+  // @return the parts of every line, in the order of the geometry
+  tictactoeai::BatchLines SplitLines(const tictactoe::BoardGeometry& geometry,
+                                     unsigned int word_count)
+  {
+    tictactoeai::BatchLines lines;
+
+    for (unsigned int line = 0; line < geometry.get_line_count(); ++line)
+    {
+      const tictactoe::Bitboard& mask = geometry.get_line_mask(line);
+      for (unsigned int word = 0; word < word_count; ++word)
+        if (mask.words_[word])
+          lines.parts_.push_back({word, mask.words_[word]});
+
+      lines.ends_.push_back(lines.parts_.size());
+    }
+
+    return lines;
+  }
+
+  // Winner of each board as EvaluateBatch reports it, 0 for none, 1 for 'X'
+  // and 2 for 'O'
+  const char kWinners[3] = {' ', 'X', 'O'};
+
+  // Adds the win score to each score and writes out the winners
+  //
+  // @param codes the winner of each board, 0, 1 or 2
+  // @param count the number of boards
+  // @param win_score the points for a win
+  // @param scores the line scores of the boards, the win score is added
+  // @param winners set to the winner of each board
+  void FinishBoards(const uint64_t* codes, unsigned int count, int win_score,
+                    int* scores, char* winners)
+  {
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      if (codes[i] == 1)
+        scores[i] += win_score;
+      else if (codes[i] == 2)
+        scores[i] -= win_score;
+
+      winners[i] = kWinners[codes[i]];
+    }
+  }
+
+  // Scores boards one at a time
+  //
+  // @param batch the boards
+  // @param lines the lines of the boards
+  // @param win_score the points for a win
+  // @param begin the first board to score
+  // @param scores set to the score of each board
+  // @param winners set to the winner of each board
+  void ScoreScalar(const tictactoeai::BoardBatch& batch,
+                   const tictactoeai::BatchLines& lines, int win_score, size_t begin,
+                   int* scores, char* winners)
+  {
+    for (size_t board = begin; board < batch.get_size(); ++board)
+    {
+      int score = 0;
+      uint64_t winner = 0;
+      unsigned int part = 0;
+
+      for (unsigned int end : lines.ends_)
+      {
+        int x_count = 0;
+        int o_count = 0;
+        bool x_full = true;
+        bool o_full = true;
+
+        for (; part < end; ++part)
+        {
+          const tictactoeai::BatchLinePart& line = lines.parts_[part];
+          uint64_t x = batch.get_words(true, line.word_)[board] & line.mask_;
+          uint64_t o = batch.get_words(false, line.word_)[board] & line.mask_;
+
+          x_count += __builtin_popcountll(x);
+          o_count += __builtin_popcountll(o);
+          x_full &= x == line.mask_;
+          o_full &= o == line.mask_;
+        }
+
+        score += (o_count == 0) * x_count - (x_count == 0) * o_count;
+        if (winner == 0)
+          winner = x_full ? 1 : (o_full ? 2 : 0);
+      }
+
+      scores[board] = score;
+      FinishBoards(&winner, 1, win_score, &scores[board], &winners[board]);
+    }
+  }
+
+#ifdef TICTACTOEAI_X86_KERNELS
+  // Number of set bits in each 64 bit lane
+  __attribute__((target("sse4.1")))
+  inline __m128i CountBits(__m128i bits)
+  {
+    const __m128i nibble_counts =
+     _mm_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m128i low_nibbles = _mm_set1_epi8(0x0f);
+
+    __m128i low = _mm_and_si128(bits, low_nibbles);
+    __m128i high = _mm_and_si128(_mm_srli_epi16(bits, 4), low_nibbles);
+    __m128i counts = _mm_add_epi8(_mm_shuffle_epi8(nibble_counts, low),
+                                  _mm_shuffle_epi8(nibble_counts, high));
+
+    return _mm_sad_epu8(counts, _mm_setzero_si128());
+  }
+
+  // Scores boards two at a time with SSE4.1, see ScoreScalar
+  //
+  // @return the first board not scored
+  __attribute__((target("sse4.1")))
+  size_t ScoreSse(const tictactoeai::BoardBatch& batch,
+                  const tictactoeai::BatchLines& lines, int win_score, int* scores,
+                  char* winners)
+  {
+    const unsigned int kLanes = 2;
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i x_code = _mm_set1_epi64x(1);
+    const __m128i o_code = _mm_set1_epi64x(2);
+
+    size_t board = 0;
+    for (; board + kLanes <= batch.get_size(); board += kLanes)
+    {
+      __m128i x_words[tictactoe::Bitboard::kWords];
+      __m128i o_words[tictactoe::Bitboard::kWords];
+      for (unsigned int word = 0; word < batch.get_word_count(); ++word)
+      {
+        x_words[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+            batch.get_words(true, word) + board));
+        o_words[word] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+            batch.get_words(false, word) + board));
+      }
+
+      __m128i score = zero;
+      __m128i winner = zero;
+      unsigned int part = 0;
+
+      for (unsigned int end : lines.ends_)
+      {
+        __m128i x_count = zero;
+        __m128i o_count = zero;
+        __m128i x_full = _mm_cmpeq_epi64(zero, zero);
+        __m128i o_full = x_full;
+
+        for (; part < end; ++part)
+        {
+          __m128i mask = _mm_set1_epi64x(lines.parts_[part].mask_);
+          __m128i x = _mm_and_si128(x_words[lines.parts_[part].word_], mask);
+          __m128i o = _mm_and_si128(o_words[lines.parts_[part].word_], mask);
+
+          x_count = _mm_add_epi64(x_count, CountBits(x));
+          o_count = _mm_add_epi64(o_count, CountBits(o));
+          x_full = _mm_and_si128(x_full, _mm_cmpeq_epi64(x, mask));
+          o_full = _mm_and_si128(o_full, _mm_cmpeq_epi64(o, mask));
+        }
+
+        score = _mm_add_epi64(score, _mm_and_si128(
+            _mm_cmpeq_epi64(o_count, zero), x_count));
+        score = _mm_sub_epi64(score, _mm_and_si128(
+            _mm_cmpeq_epi64(x_count, zero), o_count));
+
+        __m128i code = _mm_or_si128(
+            _mm_and_si128(x_full, x_code),
+            _mm_andnot_si128(x_full, _mm_and_si128(o_full, o_code)));
+        winner = _mm_or_si128(winner, _mm_and_si128(
+            _mm_cmpeq_epi64(winner, zero), code));
+      }
+
+      int64_t lane_scores[kLanes];
+      uint64_t codes[kLanes];
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(lane_scores), score);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(codes), winner);
+
+      for (unsigned int i = 0; i < kLanes; ++i)
+        scores[board + i] = lane_scores[i];
+      FinishBoards(codes, kLanes, win_score, &scores[board], &winners[board]);
+    }
+
+    return board;
+  }
+
+  // Number of set bits in each 64 bit lane
+  __attribute__((target("avx2")))
+  inline __m256i CountBits(__m256i bits)
+  {
+    const __m256i nibble_counts = _mm256_setr_epi8(
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+        0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low_nibbles = _mm256_set1_epi8(0x0f);
+
+    __m256i low = _mm256_and_si256(bits, low_nibbles);
+    __m256i high = _mm256_and_si256(_mm256_srli_epi16(bits, 4), low_nibbles);
+    __m256i counts = _mm256_add_epi8(_mm256_shuffle_epi8(nibble_counts, low),
+                                     _mm256_shuffle_epi8(nibble_counts, high));
+
+    return _mm256_sad_epu8(counts, _mm256_setzero_si256());
+  }
+
+  // Scores boards four at a time with AVX2, see ScoreScalar
+  //
+  // @return the first board not scored
+  __attribute__((target("avx2")))
+  size_t ScoreAvx2(const tictactoeai::BoardBatch& batch,
+                   const tictactoeai::BatchLines& lines, int win_score, int* scores,
+                   char* winners)
+  {
+    const unsigned int kLanes = 4;
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i x_code = _mm256_set1_epi64x(1);
+    const __m256i o_code = _mm256_set1_epi64x(2);
+
+    size_t board = 0;
+    for (; board + kLanes <= batch.get_size(); board += kLanes)
+    {
+      __m256i x_words[tictactoe::Bitboard::kWords];
+      __m256i o_words[tictactoe::Bitboard::kWords];
+      for (unsigned int word = 0; word < batch.get_word_count(); ++word)
+      {
+        x_words[word] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+            batch.get_words(true, word) + board));
+        o_words[word] = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(
+            batch.get_words(false, word) + board));
+      }
+
+      __m256i score = zero;
+      __m256i winner = zero;
+      unsigned int part = 0;
+
+      for (unsigned int end : lines.ends_)
+      {
+        __m256i x_count = zero;
+        __m256i o_count = zero;
+        __m256i x_full = _mm256_cmpeq_epi64(zero, zero);
+        __m256i o_full = x_full;
+
+        for (; part < end; ++part)
+        {
+          __m256i mask = _mm256_set1_epi64x(lines.parts_[part].mask_);
+          __m256i x = _mm256_and_si256(x_words[lines.parts_[part].word_],
+                                       mask);
+          __m256i o = _mm256_and_si256(o_words[lines.parts_[part].word_],
+                                       mask);
+
+          x_count = _mm256_add_epi64(x_count, CountBits(x));
+          o_count = _mm256_add_epi64(o_count, CountBits(o));
+          x_full = _mm256_and_si256(x_full, _mm256_cmpeq_epi64(x, mask));
+          o_full = _mm256_and_si256(o_full, _mm256_cmpeq_epi64(o, mask));
+        }
+
+        score = _mm256_add_epi64(score, _mm256_and_si256(
+            _mm256_cmpeq_epi64(o_count, zero), x_count));
+        score = _mm256_sub_epi64(score, _mm256_and_si256(
+            _mm256_cmpeq_epi64(x_count, zero), o_count));
+
+        __m256i code = _mm256_or_si256(
+            _mm256_and_si256(x_full, x_code),
+            _mm256_andnot_si256(x_full, _mm256_and_si256(o_full, o_code)));
+        winner = _mm256_or_si256(winner, _mm256_and_si256(
+            _mm256_cmpeq_epi64(winner, zero), code));
+      }
+
+      int64_t lane_scores[kLanes];
+      uint64_t codes[kLanes];
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(lane_scores), score);
+      _mm256_storeu_si256(reinterpret_cast<__m256i*>(codes), winner);
+
+      for (unsigned int i = 0; i < kLanes; ++i)
+        scores[board + i] = lane_scores[i];
+      FinishBoards(codes, kLanes, win_score, &scores[board], &winners[board]);
+    }
+
+    return board;
+  }
+#endif
+}
+
+// Finds the fastest kernel the processor has. SSE4.1 and AVX2 are only
+// looked for on x86, everywhere else it is the scalar kernel.
+//
+// @return the kernel kKernelAuto runs
+tictactoeai::BatchKernel tictactoeai::DetectBatchKernel()
+{
+#ifdef TICTACTOEAI_X86_KERNELS
+  static const BatchKernel kernel =
+   __builtin_cpu_supports("avx2") ? kKernelAvx2 :
+   __builtin_cpu_supports("sse4.1") ? kKernelSse : kKernelScalar;
+  return kernel;
+#else
+  return kKernelScalar;
+#endif
+}
+
+// Names a kernel
+//
+// @param kernel the kernel to name
+//
+// @return auto, scalar, sse or avx2
+const char* tictactoeai::GetBatchKernelName(BatchKernel kernel)
+{
+  switch (kernel)
+  {
+    case kKernelScalar:
+      return "scalar";
+    case kKernelSse:
+      return "sse";
+    case kKernelAvx2:
+      return "avx2";
+    default:
+      return "auto";
+  }
+}
+
+// Creates an empty batch for boards of one size, splitting the lines of the
+// size into the words of the bitboards for the kernels
+//
+// @param geometry the lines of the boards that will be added
+tictactoeai::BoardBatch::BoardBatch(const tictactoe::BoardGeometry& geometry)
+    : geometry_(&geometry),
+      word_count_((geometry.get_cell_count() + 63) / 64),
+      lines_(SplitLines(geometry, word_count_)),
+      win_score_(CalcWinScore(tictactoe::TicTacToe(
+          geometry.get_width(), geometry.get_height(),
+          geometry.get_win_length())))
+{
+}
+
+// Adds a board to the end of the batch
+//
+// @param board the board to add, the same size as the batch
+void tictactoeai::BoardBatch::Add(const tictactoe::TicTacToe &board)
+{
+  // Every board of a size shares one geometry
+  if (&board.get_geometry() != geometry_)
+    throw std::invalid_argument("board is not the size of the batch");
+
+  for (unsigned int word = 0; word < word_count_; ++word)
+  {
+    words_[0][word].push_back(board.get_x_bits().words_[word]);
+    words_[1][word].push_back(board.get_o_bits().words_[word]);
+  }
+  ++size_;
+}
+
+// Removes every board, keeping the memory for the next boards
+void tictactoeai::BoardBatch::Clear()
+{
+  for (unsigned int word = 0; word < word_count_; ++word)
+  {
+    words_[0][word].clear();
+    words_[1][word].clear();
+  }
+  size_ = 0;
+}
+
+// Scores every board of a batch and finds their winners
+//
+// The scores are the same as CalcGameScore gives each board. The winner is
+// the player with the first full line in the order of the board geometry,
+// which is the winner CheckForWin reports for any board reached by play.
+//
+// @param batch the boards
+// @param scores set to the score of each board, positive when 'X' is
+//  winning, must have room for every board
+// @param winners set to 'X', 'O' or ' ' for each board, must have room for
+//  every board
+// @param kernel the instructions to use, a kernel the processor does not
+//  have is replaced by the fastest one it does
+void tictactoeai::EvaluateBatch(const BoardBatch& batch, int* scores,
+                                char* winners, BatchKernel kernel)
+{
+  if (batch.get_size() == 0)
+    return;
+
+  BatchKernel best = DetectBatchKernel();
+  if (kernel == kKernelAuto || kernel > best)
+    kernel = best;
+
+  const BatchLines& lines = batch.get_lines();
+  int win_score = batch.get_win_score();
+
+  size_t scored = 0;
+
+#ifdef TICTACTOEAI_X86_KERNELS
+  if (kernel == kKernelAvx2)
+    scored = ScoreAvx2(batch, lines, win_score, scores, winners);
+  else if (kernel == kKernelSse)
+    scored = ScoreSse(batch, lines, win_score, scores, winners);
+#endif
+
+  // The boards left over after the last full group
+  ScoreScalar(batch, lines, win_score, scored, scores, winners);
+}
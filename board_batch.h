@@ -0,0 +1,105 @@
+#ifndef BOARD_BATCH_H_
+#define BOARD_BATCH_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * Checks for wins and scores many boards of one size at once with vector
+ * instructions
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Instructions EvaluateBatch can score boards with, from slowest to fastest
+  enum BatchKernel
+  {
+    // The fastest the processor has, see DetectBatchKernel
+    kKernelAuto,
+
+    // One board at a time with no vector instructions
+    kKernelScalar,
+
+    // SSE4.1, two boards at a time
+    kKernelSse,
+
+    // AVX2, four boards at a time
+    kKernelAvx2
+  };
+
+  // Fastest kernel the processor running the program has, checked once
+  BatchKernel DetectBatchKernel();
+
+  // Name of a kernel for printing, such as avx2
+  const char* GetBatchKernelName(BatchKernel kernel);
+
+  // The cells of a line in one word of the bitboards
+  class BatchLinePart
+  {
+   public:
+    unsigned int word_;
+    uint64_t mask_;
+  };
+
+  // Every line of a board split into the words its cells are in. The parts
+  // of line i are parts_[ends_[i - 1]] up to parts_[ends_[i]].
+  class BatchLines
+  {
+   public:
+    std::vector<BatchLinePart> parts_;
+    std::vector<unsigned int> ends_;
+  };
+
+  // Boards of one size stored as a structure of arrays. Each word of the 'X'
+  // and 'O' bitboards is stored next to the same word of every other board,
+  // so one vector load reads it for several boards.
+  class BoardBatch
+  {
+   public:
+    explicit BoardBatch(const tictactoe::BoardGeometry& geometry);
+
+    void Add(const tictactoe::TicTacToe &board);
+    void Clear();
+
+    // Word of the bitboards of every board, true for 'X' false for 'O'
+    const uint64_t* get_words(bool player, unsigned int word) const
+    {
+      return words_[player ? 0 : 1][word].data();
+    }
+
+    // Get batch info
+    const tictactoe::BoardGeometry& get_geometry() const { return *geometry_; }
+    unsigned int get_word_count() const { return word_count_; }
+    size_t get_size() const { return size_; }
+    const BatchLines& get_lines() const { return lines_; }
+    int get_win_score() const { return win_score_; }
+
+   private:
+    const tictactoe::BoardGeometry* geometry_;
+    unsigned int word_count_;
+    size_t size_ = 0;
+
+    // Worked out once for the size so scoring a small batch costs nothing
+    // extra
+    BatchLines lines_;
+    int win_score_;
+
+    std::vector<uint64_t> words_[2][tictactoe::Bitboard::kWords];
+  };
+
+  // Scores every board of a batch the same as CalcGameScore, and finds the
+  // winner of each the same as TicTacToe::CheckForWin
+  void EvaluateBatch(const BoardBatch& batch, int* scores, char* winners,
+                     BatchKernel kernel = kKernelAuto);
+}
+
+#endif  // BOARD_BATCH_H_
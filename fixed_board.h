@@ -0,0 +1,237 @@
+#ifndef FIXED_BOARD_H_
+#define FIXED_BOARD_H_
+
+#include <cstdint>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * Boards whose size is known when the program is compiled
+ *
+ * The lines of a FixedBoard are constexpr tables built by the compiler, so
+ * every loop over them has a fixed trip count and is unrolled. Boards have at
+ * most 64 cells so each player's tokens fit in one word. Any other size uses
+ * the runtime BoardGeometry instead.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoe
+{
+  // Calls visit(line, cell) for each of the k cells of every line of a width
+  // by height board, in the same order as BoardGeometry lists them
+  template <class Visit>
+  constexpr void VisitFixedLines(unsigned int width, unsigned int height,
+                                 unsigned int k, Visit visit)
+  {
+    const int steps[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+    unsigned int line = 0;
+
+    for (unsigned int direction = 0; direction < 4; ++direction)
+    {
+      int dx = steps[direction][0];
+      int dy = steps[direction][1];
+
+      // Rows are listed row by row and everything else column by column
+      unsigned int outer = direction == 0 ? height : width;
+      unsigned int inner = direction == 0 ? width : height;
+
+      for (unsigned int a = 0; a < outer; ++a)
+      {
+        for (unsigned int b = 0; b < inner; ++b)
+        {
+          int x = direction == 0 ? b : a;
+          int y = direction == 0 ? a : b;
+          int end_x = x + dx * (int(k) - 1);
+          int end_y = y + dy * (int(k) - 1);
+
+          if (end_x < 0 || end_x >= int(width) ||
+              end_y < 0 || end_y >= int(height))
+            continue;
+
+          for (int i = 0; i < int(k); ++i)
+            visit(line, (y + dy * i) * width + (x + dx * i));
+          ++line;
+        }
+      }
+    }
+  }
+
+  // Number of lines of k cells on a width by height board
+  constexpr unsigned int CountFixedLines(unsigned int width,
+                                         unsigned int height, unsigned int k)
+  {
+    unsigned int lines = 0;
+    VisitFixedLines(width, height, k, [&](unsigned int line, unsigned int) {
+      lines = line + 1;
+    });
+    return lines;
+  }
+
+  // Most lines of k cells any one cell of a width by height board is on
+  constexpr unsigned int CountMostCellLines(unsigned int width,
+                                            unsigned int height,
+                                            unsigned int k)
+  {
+    unsigned int counts[kMaxCells] = {};
+    VisitFixedLines(width, height, k, [&](unsigned int, unsigned int cell) {
+      ++counts[cell];
+    });
+
+    unsigned int most = 0;
+    for (unsigned int cell = 0; cell < width * height; ++cell)
+      most = counts[cell] > most ? counts[cell] : most;
+    return most;
+  }
+
+  // Line masks of a board size, built by BuildFixedTables
+  template <unsigned int W, unsigned int H, unsigned int K>
+  class FixedTables
+  {
+   public:
+    static constexpr unsigned int kCells = W * H;
+    static constexpr unsigned int kLines = CountFixedLines(W, H, K);
+    static constexpr unsigned int kCellLines = CountMostCellLines(W, H, K);
+
+    uint64_t line_masks_[kLines] = {};
+
+    // Masks of the lines through each cell. Cells on fewer than kCellLines
+    // lines are padded with a mask of every bit, which no player can fill
+    // since both always have a cell the other does not.
+    uint64_t cell_masks_[kCells][kCellLines] = {};
+  };
+
+  template <unsigned int W, unsigned int H, unsigned int K>
+  constexpr FixedTables<W, H, K> BuildFixedTables()
+  {
+    FixedTables<W, H, K> tables;
+    unsigned int filled[W * H] = {};
+
+    for (unsigned int cell = 0; cell < W * H; ++cell)
+      for (unsigned int i = 0; i < tables.kCellLines; ++i)
+        tables.cell_masks_[cell][i] = ~uint64_t(0);
+
+    VisitFixedLines(W, H, K, [&](unsigned int line, unsigned int cell) {
+      tables.line_masks_[line] |= uint64_t(1) << cell;
+    });
+
+    for (unsigned int line = 0; line < tables.kLines; ++line)
+      for (unsigned int cell = 0; cell < W * H; ++cell)
+        if ((tables.line_masks_[line] >> cell) & 1)
+          tables.cell_masks_[cell][filled[cell]++] = tables.line_masks_[line];
+
+    return tables;
+  }
+
+  // An m,n,k-game board of a size fixed when the program is compiled. Has
+  // only the tokens, for code that places and removes them in a tight loop.
+  template <unsigned int W, unsigned int H, unsigned int K>
+  class FixedBoard
+  {
+   public:
+    static_assert(W * H >= 1 && W * H <= 64,
+                  "a fixed board has between 1 and 64 cells");
+    static_assert(K >= 1 && (K <= W || K <= H),
+                  "a fixed board has at least one line");
+
+    static constexpr unsigned int kCells = W * H;
+    static constexpr FixedTables<W, H, K> kTables = BuildFixedTables<W, H, K>();
+    static constexpr uint64_t kCellMask =
+     kCells == 64 ? ~uint64_t(0) : (uint64_t(1) << kCells) - 1;
+
+    FixedBoard() = default;
+
+    // Copies the tokens of a board, which must be W by H with K in a row
+    explicit FixedBoard(const TicTacToe &board)
+    {
+      bits_[0] = board.get_x_bits().words_[0];
+      bits_[1] = board.get_o_bits().words_[0];
+    }
+
+    // Whether a runtime board has this size
+    static bool Matches(const TicTacToe &board)
+    {
+      return board.get_width() == W && board.get_height() == H &&
+             board.get_win_length() == K;
+    }
+
+    // Places a token on an empty cell
+    //
+    // @param player true for 'X' false for 'O'
+    // @param cell the cell to place the token on
+    //
+    // @return whether the token wins the game
+    bool Place(bool player, unsigned int cell)
+    {
+      uint64_t& bits = bits_[player ? 0 : 1];
+      bits |= uint64_t(1) << cell;
+
+      bool won = false;
+      for (unsigned int i = 0; i < kTables.kCellLines; ++i)
+        won |= (bits & kTables.cell_masks_[cell][i]) ==
+               kTables.cell_masks_[cell][i];
+      return won;
+    }
+
+    void Remove(unsigned int cell)
+    {
+      bits_[0] &= ~(uint64_t(1) << cell);
+      bits_[1] &= ~(uint64_t(1) << cell);
+    }
+
+    // Whether the player has a full line anywhere
+    bool HasWon(bool player) const
+    {
+      uint64_t bits = bits_[player ? 0 : 1];
+
+      bool won = false;
+      for (unsigned int line = 0; line < kTables.kLines; ++line)
+        won |= (bits & kTables.line_masks_[line]) == kTables.line_masks_[line];
+      return won;
+    }
+
+    // Sum over every line of the tokens in it when only one player has tokens
+    // in it, positive for 'X', the same as TicTacToe::get_line_score
+    int GetLineScore() const
+    {
+      int score = 0;
+      for (unsigned int line = 0; line < kTables.kLines; ++line)
+      {
+        int x = __builtin_popcountll(bits_[0] & kTables.line_masks_[line]);
+        int o = __builtin_popcountll(bits_[1] & kTables.line_masks_[line]);
+        score += (o == 0) * x - (x == 0) * o;
+      }
+      return score;
+    }
+
+    // Lists the empty cells from the first cell up
+    //
+    // @param cells set to the cells, must have room for every cell
+    //
+    // @return the number of empty cells
+    unsigned int ListEmpty(unsigned short* cells) const
+    {
+      unsigned int count = 0;
+      for (uint64_t empty = ~(bits_[0] | bits_[1]) & kCellMask; empty;
+           empty &= empty - 1)
+        cells[count++] = __builtin_ctzll(empty);
+      return count;
+    }
+
+    unsigned int get_empty_spaces() const
+    {
+      return kCells - __builtin_popcountll(bits_[0] | bits_[1]);
+    }
+
+    uint64_t get_bits(bool player) const { return bits_[player ? 0 : 1]; }
+
+   private:
+    uint64_t bits_[2] = {0, 0};
+  };
+}
+
+#endif  // FIXED_BOARD_H_
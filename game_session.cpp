@@ -0,0 +1,285 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <utility>
+#include <vector>
+
+#include "game_session.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the GameSession class
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+// Starts a session from a board
+//
+// @param board the board to play from
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options how to search, the table and node pool given are not used,
+//  the session has its own
+// @param mcts_nodes the most nodes the Monte Carlo tree can have
+tictactoeai::GameSession::GameSession(const tictactoe::TicTacToe &board,
+                                      bool player,
+                                      const SearchOptions &options,
+                                      size_t mcts_nodes)
+    : board_(board), player_(player), options_(options),
+      trees_{MctsNodePool(mcts_nodes), MctsNodePool(mcts_nodes)}
+{
+}
+
+// Stops pondering before the session goes away
+tictactoeai::GameSession::~GameSession()
+{
+  StopPondering();
+}
+
+// Makes a placement choice for the player to move, see MakePlacementChoice
+//
+// @param move_depth the amount of moves to look ahead
+//
+// @return the placement choice, the move is not played
+std::pair<unsigned int, unsigned int> tictactoeai::GameSession::ChooseMove(
+    unsigned int move_depth)
+{
+  SearchResult answer;
+  bool answered = move_depth == move_depth_ &&
+                  TakePonderAnswer(std::chrono::milliseconds(0), &answer);
+  StopPondering();
+
+  last_depth_ = move_depth;
+  move_depth_ = move_depth;
+
+  if (answered)
+    return answer.placement_;
+
+  return MakePlacementChoice(board_, move_depth, player_, MakeOptions());
+}
+
+// Makes a placement choice for the player to move within a time limit, see
+// MakeTimedPlacementChoice
+//
+// @param time_budget how long the search may take
+//
+// @return the placement choice and what the search found, the move is not
+//  played
+tictactoeai::SearchResult tictactoeai::GameSession::ChooseTimedMove(
+    std::chrono::milliseconds time_budget)
+{
+  SearchResult result;
+  bool answered = move_depth_ == 0 && TakePonderAnswer(time_budget, &result);
+  StopPondering();
+
+  if (!answered)
+    result = MakeTimedPlacementChoice(board_, time_budget, player_,
+                                      MakeOptions());
+
+  last_depth_ = std::max(1u, result.depth_);
+  move_depth_ = 0;
+  return result;
+}
+
+// Places a token for the player to move and hands the turn to the other
+// player. The Monte Carlo tree keeps only the subtree of the move, or starts
+// over when the move was never played out. Pondering stops unless the move
+// is the reply it guessed.
+//
+// @param x the column to place the token in
+// @param y the row to place the token in
+void tictactoeai::GameSession::PlayMove(unsigned int x, unsigned int y)
+{
+  unsigned int cell = y * board_.get_width() + x;
+
+  if (ponder_.valid() && !ponder_hit_ && ponder_move_ == int(cell))
+  {
+    ponder_hit_ = true;
+    ++ponder_hits_;
+  }
+  else
+    StopPondering();
+
+  MctsNodePool& tree = trees_[tree_];
+  MctsNodePool& next = trees_[1 - tree_];
+
+  next.Clear();
+  if (tree.get_used() > 0 && tree[0].state_ == MctsNode::kExpanded)
+  {
+    for (uint32_t i = tree[0].first_child_;
+         i < tree[0].first_child_ + tree[0].child_count_; ++i)
+    {
+      if (tree[i].cell_ == cell && tree[i].visits_ > 0)
+      {
+        next.CopySubtree(tree, i);
+        break;
+      }
+    }
+  }
+
+  tree.Clear();
+  tree_ = 1 - tree_;
+
+  board_.PlaceToken(player_, x, y);
+  player_ = !player_;
+}
+
+// Starts pondering the board for the player to move, until the next call
+// to ChooseMove, ChooseTimedMove, PlayMove or StopPondering. Does nothing
+// when the game is over or the session is already pondering.
+void tictactoeai::GameSession::StartPondering()
+{
+  if (ponder_.valid() || board_.IsGameOver().first)
+    return;
+
+  std::promise<SearchResult> answer;
+  ponder_answer_ = answer.get_future();
+  ponder_move_ = -1;
+  ponder_ = std::async(std::launch::async, &GameSession::Ponder, this,
+                       board_, player_, MakeOptions(), std::move(answer));
+}
+
+// Stops pondering and waits for the search to give up, what it found stays
+// in the table and tree
+void tictactoeai::GameSession::StopPondering()
+{
+  if (!ponder_.valid())
+    return;
+
+  stop_ponder_ = true;
+  ponder_.get();
+  stop_ponder_ = false;
+
+  ponder_answer_ = std::future<SearchResult>();
+  ponder_move_ = -1;
+  ponder_hit_ = false;
+}
+
+// Gets the number of playouts already made from the board, the head start
+// the next Monte Carlo tree search has
+//
+// @return the playouts of the root of the tree
+uint32_t tictactoeai::GameSession::get_tree_playouts() const
+{
+  const MctsNodePool& tree = trees_[tree_];
+  return tree.get_used() > 0 ? tree[0].visits_.load() : 0;
+}
+
+// Builds the options for a search of the current board with the session's
+// table and tree. Entries of the table from earlier moves give way to the
+// new search first.
+//
+// @return the options to search with
+tictactoeai::SearchOptions tictactoeai::GameSession::MakeOptions()
+{
+  table_.NewGeneration();
+
+  SearchOptions options = options_;
+  options.table_ = &table_;
+  options.mcts_pool_ = &trees_[tree_];
+  options.mcts_keep_tree_ = true;
+  return options;
+}
+
+// Takes the answer pondering found to the reply that was played, when the
+// reply was the one it guessed
+//
+// @param time_budget how much longer to let a timed search of the answer
+//  run, a fixed depth search is always waited for
+// @param result set to the answer
+//
+// @return whether there was an answer, when there is none the move has to
+//  be searched
+bool tictactoeai::GameSession::TakePonderAnswer(
+    std::chrono::milliseconds time_budget, SearchResult* result)
+{
+  if (!ponder_hit_)
+    return false;
+
+  // A timed search still running gives the deepest search it finished
+  if (move_depth_ == 0)
+  {
+    ponder_answer_.wait_for(time_budget);
+    stop_ponder_ = true;
+  }
+
+  *result = ponder_answer_.get();
+
+  return result->placement_.first != 100;
+}
+
+// Searches the likely replies of the player to move until it is stopped
+//
+// Monte Carlo tree search just keeps growing the tree of the board, the
+// replies that look best get the most playouts. Minimax guesses the reply
+// with a search one move shallower than the last one, which the table mostly
+// answers, and searches the answer to it the way the last choice was made.
+// Then it searches the answers to the other replies into the table in turn.
+//
+// @param board the board the other player is about to move on
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the session's options, stopped through stop_ponder_
+// @param answer set to the answer to the guessed reply, a placement of
+//  {100, 100} when there is none
+void tictactoeai::GameSession::Ponder(tictactoe::TicTacToe board, bool player,
+                                      SearchOptions options,
+                                      std::promise<SearchResult> answer)
+{
+  options.cancel_ = &stop_ponder_;
+
+  if (ChooseEngine(board, options) == kEngineMcts)
+  {
+    answer.set_value(SearchResult());
+    options.mcts_iterations_ = 0;
+    MakeMctsPlacementChoice(board, player, options, kNoTimeLimit);
+    return;
+  }
+
+  unsigned int width = board.get_width();
+  unsigned int guess_depth = std::min(std::max(last_depth_, 2u) - 1,
+                                      board.get_empty_spaces());
+  SearchResult guess = AnalyzePlacement(board, guess_depth, player, options);
+  if (stop_ponder_ || guess.placement_.first == 100)
+  {
+    answer.set_value(SearchResult());
+    return;
+  }
+
+  unsigned int guess_cell = guess.placement_.second * width +
+                            guess.placement_.first;
+  std::vector<unsigned int> replies(1, guess_cell);
+  for (unsigned int cell = 0; cell < board.get_geometry().get_cell_count();
+       ++cell)
+    if (cell != guess_cell && board.GetCell(cell % width, cell / width) == ' ')
+      replies.push_back(cell);
+
+  ponder_move_ = guess_cell;
+
+  for (unsigned int i = 0; i < replies.size(); ++i)
+  {
+    if (i > 0 && stop_ponder_)
+      break;
+
+    tictactoe::TicTacToe reply = board;
+    reply.PlaceToken(player, replies[i] % width, replies[i] / width);
+
+    SearchResult result;
+    if (!reply.IsGameOver().first)
+    {
+      if (move_depth_ > 0)
+        result.placement_ = MakePlacementChoice(reply, move_depth_, !player,
+                                                options);
+      else
+        result = MakeTimedPlacementChoice(reply, kNoTimeLimit, !player,
+                                          options);
+    }
+
+    if (i == 0)
+      answer.set_value(result);
+  }
+}
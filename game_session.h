@@ -0,0 +1,112 @@
+#ifndef GAME_SESSION_H_
+#define GAME_SESSION_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <utility>
+
+#include "mcts.h"
+#include "tictactoe.h"
+#include "tictactoe_ai.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * A game the a.i. plays move after move, keeping what each search learned
+ * for the next one
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // The board of a game and the search state carried between its moves. The
+  // transposition table is kept for the whole game, and the Monte Carlo tree
+  // is cut down to the subtree of every move played so the next search
+  // starts from the playouts already made below it.
+  //
+  // While the other player thinks the session can ponder on a thread of its
+  // own. It guesses their reply and searches the answer to it the way the
+  // next choice will, so when the guess is right that search just carries on
+  // as the next choice, and the other replies are searched into the table.
+  // Monte Carlo tree search grows the tree, which the reply then cuts down.
+  class GameSession
+  {
+   public:
+    GameSession(const tictactoe::TicTacToe &board, bool player,
+                const SearchOptions &options = SearchOptions(),
+                size_t mcts_nodes = kDefaultMctsNodes);
+
+    ~GameSession();
+
+    GameSession(const GameSession&) = delete;
+    GameSession& operator=(const GameSession&) = delete;
+
+    // Decide where the player to move should put the next token
+    std::pair<unsigned int, unsigned int> ChooseMove(unsigned int move_depth);
+    SearchResult ChooseTimedMove(std::chrono::milliseconds time_budget);
+
+    // Places a token for the player to move, chosen or not
+    void PlayMove(unsigned int x, unsigned int y);
+
+    // Search on another thread until the next move is chosen or played
+    void StartPondering();
+    void StopPondering();
+
+    // Get session info
+    const tictactoe::TicTacToe& get_board() const { return board_; }
+    bool get_player() const { return player_; }
+    TranspositionTable& get_table() { return table_; }
+    uint32_t get_tree_playouts() const;
+    unsigned int get_ponder_hits() const { return ponder_hits_; }
+    bool is_pondering() const { return ponder_.valid(); }
+
+   private:
+    SearchOptions MakeOptions();
+    void Ponder(tictactoe::TicTacToe board, bool player,
+                SearchOptions options, std::promise<SearchResult> answer);
+    bool TakePonderAnswer(std::chrono::milliseconds time_budget,
+                          SearchResult* result);
+
+    tictactoe::TicTacToe board_;
+    bool player_;
+    SearchOptions options_;
+    TranspositionTable table_;
+
+    // The tree of the board is in trees_[tree_], the other pool is where the
+    // subtree of the next move is copied to
+    MctsNodePool trees_[2];
+    unsigned int tree_ = 0;
+
+    // Depth the last choice looked ahead, the guess at the reply looks one
+    // move less ahead
+    unsigned int last_depth_ = 1;
+
+    // Depth the last ChooseMove asked for, 0 when the last choice was timed.
+    // Pondering answers the guessed reply the same way.
+    unsigned int move_depth_ = 0;
+
+    std::future<void> ponder_;
+    std::atomic<bool> stop_ponder_{false};
+
+    // Cell of the reply the pondering guessed, -1 until it has guessed
+    std::atomic<int> ponder_move_{-1};
+
+    // The answer to the guessed reply, ready once its search finishes or is
+    // stopped
+    std::future<SearchResult> ponder_answer_;
+
+    // Set when the reply played was the guess, the pondering then goes on
+    // until the next choice takes its answer
+    bool ponder_hit_ = false;
+    unsigned int ponder_hits_ = 0;
+  };
+}
+
+#endif  // GAME_SESSION_H_
@@ -0,0 +1,694 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <memory>
+#include <new>
+#include <type_traits>
+#include <vector>
+
+#include "fixed_board.h"
+#include "mcts.h"
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ *
+ * File for managing the Monte Carlo tree search, a second way for the a.i. to
+ * choose a placement for boards too big to search every move of
+ *
+ * Each iteration follows the tree down from the root picking children with
+ * UCT, plays random moves from the leaf it reaches until the game ends, and
+ * adds the result to every node it went through. The move played the most is
+ * chosen. To learn more check out the wikipedia article
+ * - https://en.wikipedia.org/wiki/Monte_Carlo_tree_search
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+// Makes a pool with room for the given number of nodes
+//
+// @param max_nodes the most nodes the pool can hand out before it is cleared
+tictactoeai::MctsNodePool::MctsNodePool(size_t max_nodes)
+    : memory_(new unsigned char[max_nodes * sizeof(MctsNode)]),
+      nodes_(reinterpret_cast<MctsNode*>(memory_.get())), capacity_(max_nodes)
+{
+  static_assert(std::is_trivially_destructible<MctsNode>::value,
+                "nodes are never destroyed");
+}
+
+// Takes a run of nodes from the pool, each one an unvisited leaf
+//
+// @param count the number of nodes
+// @param first set to the index of the first node
+//
+// @return whether the pool had room, once it runs out every later call fails
+//  until the pool is cleared
+bool tictactoeai::MctsNodePool::Allocate(unsigned int count, uint32_t* first)
+{
+  size_t start = used_.fetch_add(count, std::memory_order_relaxed);
+  if (start + count > capacity_)
+    return false;
+
+  for (size_t i = start; i < start + count; ++i)
+    new (&nodes_[i]) MctsNode();
+
+  *first = start;
+  return true;
+}
+
+// Hands every node back, the pool must not be in use
+void tictactoeai::MctsNodePool::Clear()
+{
+  used_.store(0, std::memory_order_relaxed);
+}
+
+// Replaces the nodes of the pool with a copy of the subtree under a node of
+// another pool, children before grandchildren so the children of a node stay
+// next to each other. The node becomes the first node. Nodes that do not fit
+// are left out, their parents become leaves again.
+//
+// @param from the pool to copy from, must not be in use
+// @param node the index of the node in from
+void tictactoeai::MctsNodePool::CopySubtree(const MctsNodePool& from,
+                                            uint32_t node)
+{
+  Clear();
+
+  uint32_t root;
+  if (!Allocate(1, &root))
+    return;
+
+  // Index in from of each node copied so far, in the order they were copied
+  std::vector<uint32_t> sources(1, node);
+
+  for (size_t i = 0; i < sources.size(); ++i)
+  {
+    const MctsNode& source = from[sources[i]];
+    MctsNode& copy = nodes_[i];
+
+    copy.visits_.store(source.visits_.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    copy.points_.store(source.points_.load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    copy.cell_ = source.cell_;
+
+    uint32_t first;
+    if (source.state_.load(std::memory_order_acquire) != MctsNode::kExpanded ||
+        !Allocate(source.child_count_, &first))
+      continue;
+
+    copy.first_child_ = first;
+    copy.child_count_ = source.child_count_;
+    copy.state_.store(MctsNode::kExpanded, std::memory_order_relaxed);
+
+    for (uint32_t child = 0; child < source.child_count_; ++child)
+      sources.push_back(source.first_child_ + child);
+  }
+}
+
+// Gets the number of nodes handed out since the pool was cleared
+size_t tictactoeai::MctsNodePool::get_used() const
+{
+  return std::min(used_.load(std::memory_order_relaxed), capacity_);
+}
+
+namespace
+{
+  // Points a playout gives the player who placed the token of a node
+  const uint32_t kWinPoints = 2;
+  const uint32_t kTiePoints = 1;
+
+  // A leaf only gets children once it has had this many playouts, so moves
+  // that are only tried a few times do not fill up the pool
+  const uint32_t kExpandVisits = 8;
+
+  // Small and fast random number generator for the playouts, xorshift64*
+  class PlayoutRandom
+  {
+   public:
+    // @param seed any number, each thread should get a different one
+    explicit PlayoutRandom(uint64_t seed)
+    {
+      // splitmix64 so seeds that are close give unrelated sequences
+      seed += 0x9e3779b97f4a7c15ULL;
+      seed = (seed ^ (seed >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      seed = (seed ^ (seed >> 27)) * 0x94d049bb133111ebULL;
+      state_ = (seed ^ (seed >> 31)) | 1;
+    }
+
+    uint64_t Next()
+    {
+      state_ ^= state_ >> 12;
+      state_ ^= state_ << 25;
+      state_ ^= state_ >> 27;
+      return state_ * 0x2545f4914f6cdd1dULL;
+    }
+
+    // Random number from 0 up to (not including) bound
+    unsigned int Below(unsigned int bound)
+    {
+      return (uint64_t(uint32_t(Next() >> 32)) * bound) >> 32;
+    }
+
+   private:
+    uint64_t state_;
+  };
+
+  // Only the tokens of a board, small enough to copy for every playout. Wins
+  // are found with the lines of the board geometry, the same rules TicTacToe
+  // plays by. Boards of the common sizes play out on a FixedBoard instead,
+  // which has the same methods.
+  class PlayoutBoard
+  {
+   public:
+    explicit PlayoutBoard(const tictactoe::TicTacToe &board)
+        : geometry_(&board.get_geometry()),
+          empty_spaces_(board.get_empty_spaces())
+    {
+      bits_[0] = board.get_x_bits();
+      bits_[1] = board.get_o_bits();
+      tokens_[0] = bits_[0].Count();
+      tokens_[1] = bits_[1].Count();
+    }
+
+    // Places a token on an empty cell
+    //
+    // @param player true for 'X' false for 'O'
+    // @param cell the cell to place the token on
+    //
+    // @return whether the token wins the game
+    bool Place(bool player, unsigned int cell)
+    {
+      unsigned int side = player ? 0 : 1;
+      bits_[side].Set(cell);
+      --empty_spaces_;
+
+      if (++tokens_[side] < geometry_->get_win_length())
+        return false;
+
+      for (const unsigned short* line = geometry_->get_cell_lines_begin(cell);
+           line != geometry_->get_cell_lines_end(cell); ++line)
+        if (bits_[side].Contains(geometry_->get_line_mask(*line)))
+          return true;
+
+      return false;
+    }
+
+    // Lists the empty cells from the first cell up
+    //
+    // @param cells set to the cells, must have room for every cell
+    //
+    // @return the number of empty cells
+    unsigned int ListEmpty(unsigned short* cells) const
+    {
+      unsigned int cell_count = geometry_->get_cell_count();
+      unsigned int count = 0;
+
+      for (unsigned int word = 0; word * 64 < cell_count; ++word)
+      {
+        uint64_t empty = ~(bits_[0].words_[word] | bits_[1].words_[word]);
+        if (cell_count - word * 64 < 64)
+          empty &= (uint64_t(1) << (cell_count - word * 64)) - 1;
+
+        for (; empty; empty &= empty - 1)
+          cells[count++] = word * 64 + __builtin_ctzll(empty);
+      }
+
+      return count;
+    }
+
+    unsigned int get_empty_spaces() const { return empty_spaces_; }
+
+   private:
+    const tictactoe::BoardGeometry* geometry_;
+    tictactoe::Bitboard bits_[2];
+    unsigned int tokens_[2];
+    unsigned int empty_spaces_;
+  };
+
+  // State shared by every thread of a search
+  class MctsShared
+  {
+   public:
+    tictactoeai::MctsNodePool* pool_;
+
+    // Which players turn it is at the root, true for 'X' false for 'O'
+    bool player_;
+
+    double exploration_;
+
+    // Iterations to run, 0 for no limit
+    uint64_t max_iterations_;
+    std::atomic<uint64_t> started_{0};
+
+    std::chrono::steady_clock::time_point deadline_;
+    bool has_deadline_ = false;
+    const std::atomic<bool>* cancel_ = NULL;
+    std::atomic<bool> stopped_{false};
+  };
+
+  // What one thread of a search did
+  class MctsCounters
+  {
+   public:
+    uint64_t playouts_ = 0;
+    uint64_t expanded_ = 0;
+    unsigned int max_depth_ = 0;
+  };
+
+  // Finds a cell that finishes a line for the player
+  //
+  // @param board the board to look at
+  // @param player true for 'X' false for 'O'
+  //
+  // @return the cell, -1 when there is none
+  int FindWinningCell(const tictactoe::TicTacToe &board, bool player)
+  {
+    const tictactoe::BoardGeometry& geometry = board.get_geometry();
+    unsigned int threat = board.get_win_length() - 1;
+
+    for (unsigned int line = 0; line < geometry.get_line_count(); ++line)
+    {
+      if (board.get_line_count(line, player) != threat ||
+          board.get_line_count(line, !player) != 0)
+        continue;
+
+      const unsigned short* cells = geometry.get_line_cells(line);
+      for (unsigned int i = 0; i < board.get_win_length(); ++i)
+        if (board.GetCell(cells[i] % board.get_width(),
+                          cells[i] / board.get_width()) == ' ')
+          return cells[i];
+    }
+
+    return -1;
+  }
+
+  // Gives a leaf its children, one for each empty cell
+  //
+  // @param pool the pool to take the children from
+  // @param node the leaf
+  // @param board the board of the leaf
+  // @param counters the counters of the thread
+  //
+  // @return whether the node now has children, false when another thread is
+  //  already expanding it or the pool is full
+  template <class Board>
+  bool Expand(tictactoeai::MctsNodePool* pool, tictactoeai::MctsNode* node,
+              const Board& board, MctsCounters* counters)
+  {
+    uint8_t leaf = tictactoeai::MctsNode::kLeaf;
+    if (!node->state_.compare_exchange_strong(leaf,
+                                              tictactoeai::MctsNode::kExpanding))
+      return false;
+
+    unsigned short cells[tictactoe::kMaxCells];
+    unsigned int count = board.ListEmpty(cells);
+    uint32_t first;
+
+    if (!pool->Allocate(count, &first))
+    {
+      node->state_.store(tictactoeai::MctsNode::kFull,
+                         std::memory_order_relaxed);
+      return false;
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+      (*pool)[first + i].cell_ = cells[i];
+
+    node->first_child_ = first;
+    node->child_count_ = count;
+    node->state_.store(tictactoeai::MctsNode::kExpanded,
+                       std::memory_order_release);
+
+    ++counters->expanded_;
+    return true;
+  }
+
+  // Picks the child to follow with UCT, the child with the best win rate
+  // plus a bonus that grows for children played less often than their
+  // siblings. Children that have not been played yet are picked first.
+  //
+  // @param pool the pool the nodes are in
+  // @param node the node to pick a child of, must be expanded
+  // @param exploration how much the bonus counts for
+  //
+  // @return the index of the child
+  uint32_t SelectChild(const tictactoeai::MctsNodePool& pool,
+                       const tictactoeai::MctsNode& node, double exploration)
+  {
+    uint32_t parent_visits = node.visits_.load(std::memory_order_relaxed);
+    double log_visits = std::log(double(std::max(parent_visits, 1u)));
+
+    uint32_t best = node.first_child_;
+    double best_value = -1;
+
+    for (uint32_t i = node.first_child_;
+         i < node.first_child_ + node.child_count_; ++i)
+    {
+      const tictactoeai::MctsNode& child = pool[i];
+      uint32_t visits = child.visits_.load(std::memory_order_relaxed);
+
+      if (visits == 0)
+        return i;
+
+      double win_rate = child.points_.load(std::memory_order_relaxed) /
+                        double(kWinPoints * visits);
+      double value = win_rate + exploration * std::sqrt(log_visits / visits);
+
+      if (value > best_value)
+      {
+        best_value = value;
+        best = i;
+      }
+    }
+
+    return best;
+  }
+
+  // Plays random moves until the game is over
+  //
+  // @param board the board to play on
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param random the random numbers of the thread
+  //
+  // @return the winner, 'X', 'O' or ' ' for a tie
+  template <class Board>
+  char Playout(Board* board, bool player, PlayoutRandom* random)
+  {
+    unsigned short cells[tictactoe::kMaxCells];
+    unsigned int count = board->ListEmpty(cells);
+
+    while (count > 0)
+    {
+      unsigned int i = random->Below(count);
+      unsigned int cell = cells[i];
+      cells[i] = cells[--count];
+
+      if (board->Place(player, cell))
+        return player ? 'X' : 'O';
+
+      player = !player;
+    }
+
+    return ' ';
+  }
+
+  // Runs iterations until the search runs out of iterations or time
+  //
+  // @param shared the state shared by every thread of the search
+  // @param root_board the board of the root
+  // @param seed the seed of the random playouts of the thread
+  // @param counters the counters of the thread
+  template <class Board>
+  void RunIterations(MctsShared* shared, const Board& root_board,
+                     uint64_t seed, MctsCounters* counters)
+  {
+    tictactoeai::MctsNodePool& pool = *shared->pool_;
+    PlayoutRandom random(seed);
+    uint32_t path[tictactoe::kMaxCells + 1];
+
+    for (uint64_t done = 0; ; ++done)
+    {
+      if (shared->stopped_.load(std::memory_order_relaxed))
+        break;
+
+      if ((done & 63) == 0 &&
+          ((shared->has_deadline_ &&
+            std::chrono::steady_clock::now() >= shared->deadline_) ||
+           (shared->cancel_ &&
+            shared->cancel_->load(std::memory_order_relaxed))))
+      {
+        shared->stopped_ = true;
+        break;
+      }
+
+      if (shared->max_iterations_ > 0 &&
+          shared->started_.fetch_add(1, std::memory_order_relaxed) >=
+           shared->max_iterations_)
+        break;
+
+      Board board(root_board);
+      bool player = shared->player_;
+      char winner = 0;
+
+      unsigned int depth = 0;
+      path[depth++] = 0;
+      pool[0].visits_.fetch_add(1, std::memory_order_relaxed);
+
+      // Follows the tree down until it reaches a leaf or the game ends
+      while (true)
+      {
+        tictactoeai::MctsNode& node = pool[path[depth - 1]];
+
+        if (node.state_.load(std::memory_order_acquire) !=
+             tictactoeai::MctsNode::kExpanded &&
+            ((depth > 1 && node.visits_.load(std::memory_order_relaxed) <
+                            kExpandVisits) ||
+             !Expand(&pool, &node, board, counters)))
+          break;
+
+        uint32_t child = SelectChild(pool, node, shared->exploration_);
+        pool[child].visits_.fetch_add(1, std::memory_order_relaxed);
+        path[depth++] = child;
+
+        if (board.Place(player, pool[child].cell_))
+          winner = player ? 'X' : 'O';
+        else if (board.get_empty_spaces() == 0)
+          winner = ' ';
+
+        player = !player;
+        if (winner)
+          break;
+      }
+
+      if (!winner)
+        winner = Playout(&board, player, &random);
+
+      // The token of the root was placed by the other player, then the
+      // players take turns down the path
+      bool mover = !shared->player_;
+      for (unsigned int i = 0; i < depth; ++i)
+      {
+        uint32_t points = 0;
+        if (winner == ' ')
+          points = kTiePoints;
+        else if ((winner == 'X') == mover)
+          points = kWinPoints;
+
+        if (points)
+          pool[path[i]].points_.fetch_add(points, std::memory_order_relaxed);
+
+        mover = !mover;
+      }
+
+      ++counters->playouts_;
+      counters->max_depth_ = std::max(counters->max_depth_, depth - 1);
+    }
+  }
+
+  // Runs iterations on the calling thread and every worker until the search
+  // is done
+  //
+  // @param shared the state shared by every thread of the search
+  // @param root_board the board of the root
+  // @param seed the seed of the calling thread, each worker adds its number
+  // @param workers the workers to run on too, NULL for none
+  // @param counters set to the counters of each thread, the calling thread
+  //  first, must have room for every worker
+  template <class Board>
+  void RunThreads(MctsShared* shared, const Board& root_board, uint64_t seed,
+                  tictactoeai::WorkStealingPool* workers,
+                  std::vector<MctsCounters>* counters)
+  {
+    unsigned int helpers = workers ? workers->get_thread_count() : 0;
+
+    tictactoeai::TaskGroup group;
+    for (unsigned int i = 1; i <= helpers; ++i)
+      workers->Submit(&group, [&, i]() {
+        RunIterations(shared, root_board, seed + i, &(*counters)[i]);
+      });
+
+    RunIterations(shared, root_board, seed, &(*counters)[0]);
+    if (workers)
+      workers->Wait(&group);
+  }
+}
+
+// Makes a placement choice with Monte Carlo tree search
+//
+// Runs options.mcts_iterations_ playouts, or plays out until the time budget
+// runs out when one is given, whichever comes first. With more than one
+// thread every thread grows the same tree, and the virtual loss of a playout
+// that has not finished yet steers the other threads to other moves. A move
+// that wins on the spot, or else a move that stops the other player winning
+// on their next move, is played without searching.
+//
+// With options.mcts_keep_tree_ the search grows the tree already in the
+// pool, and the playouts it holds count towards the iterations. Setting
+// options.cancel_ stops the search with the playouts made so far.
+//
+// @param board current tic-tac-toe board
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the playouts, threads and node pool to search with
+// @param time_budget how long the search may take, 0 for no time limit and
+//  kNoTimeLimit to play out until the search is cancelled
+//
+// @return the placement choice, its score from the share of playouts won
+//  scaled so that winning every playout scores a win, the deepest the tree
+//  grew and the number of playouts as nodes
+tictactoeai::SearchResult tictactoeai::MakeMctsPlacementChoice(
+    const tictactoe::TicTacToe &board,
+    bool player,
+    const SearchOptions &options,
+    std::chrono::milliseconds time_budget)
+{
+  std::chrono::steady_clock::time_point start =
+   std::chrono::steady_clock::now();
+  SearchResult result;
+
+  if (board.IsGameOver().first)
+    return result;
+
+  unsigned int width = board.get_width();
+  int forced = FindWinningCell(board, player);
+  bool winning = forced >= 0;
+  if (!winning)
+    forced = FindWinningCell(board, !player);
+
+  if (forced >= 0)
+  {
+    result.placement_ = {forced % width, forced / width};
+    result.score_ = winning ? (player ? 1 : -1) * CalcWinScore(board) : 0;
+    result.depth_ = 1;
+    return result;
+  }
+
+  // Without a time limit the iterations say how big the tree can get
+  std::unique_ptr<MctsNodePool> local_pool;
+  MctsNodePool* pool = options.mcts_pool_;
+  if (!pool)
+  {
+    size_t max_nodes = kDefaultMctsNodes;
+    if (time_budget.count() == 0)
+      max_nodes = std::min<size_t>(
+          max_nodes, (options.mcts_iterations_ / kExpandVisits + 2) *
+                     (board.get_empty_spaces() + 1));
+
+    local_pool.reset(new MctsNodePool(max_nodes));
+    pool = local_pool.get();
+  }
+
+  // The root is always the first node
+  uint32_t root = 0;
+  if (!options.mcts_keep_tree_ || pool->get_used() == 0)
+  {
+    pool->Clear();
+    pool->Allocate(1, &root);
+  }
+
+  MctsShared shared;
+  shared.pool_ = pool;
+  shared.player_ = player;
+  shared.exploration_ = options.mcts_exploration_;
+  shared.max_iterations_ = options.mcts_iterations_;
+  shared.cancel_ = options.cancel_;
+
+  if (time_budget.count() == 0)
+    shared.max_iterations_ = std::max(1u, options.mcts_iterations_);
+  else if (time_budget != kNoTimeLimit)
+  {
+    shared.deadline_ = start + time_budget;
+    shared.has_deadline_ = true;
+  }
+
+  uint32_t kept = (*pool)[root].visits_.load(std::memory_order_relaxed);
+  if (shared.max_iterations_ > 0)
+    shared.max_iterations_ = shared.max_iterations_ > kept ?
+     shared.max_iterations_ - kept : 1;
+
+  // The calling thread runs iterations too, so one less worker is needed
+  std::unique_ptr<WorkStealingPool> local_workers;
+  WorkStealingPool* workers = options.pool_;
+  if (!workers && options.threads_ > 1)
+  {
+    local_workers.reset(new WorkStealingPool(options.threads_ - 1));
+    workers = local_workers.get();
+  }
+
+  unsigned int helpers = workers ? workers->get_thread_count() : 0;
+  std::vector<MctsCounters> counters(helpers + 1);
+
+  // The common sizes play out on a board with its lines built in
+  if (tictactoe::FixedBoard<3, 3, 3>::Matches(board))
+    RunThreads(&shared, tictactoe::FixedBoard<3, 3, 3>(board),
+               options.mcts_seed_, workers, &counters);
+  else if (tictactoe::FixedBoard<4, 4, 4>::Matches(board))
+    RunThreads(&shared, tictactoe::FixedBoard<4, 4, 4>(board),
+               options.mcts_seed_, workers, &counters);
+  else
+    RunThreads(&shared, PlayoutBoard(board), options.mcts_seed_, workers,
+               &counters);
+
+  MctsCounters total;
+  for (const MctsCounters& thread : counters)
+  {
+    total.playouts_ += thread.playouts_;
+    total.expanded_ += thread.expanded_;
+    total.max_depth_ = std::max(total.max_depth_, thread.max_depth_);
+  }
+
+  // The most played move, its win rate breaks ties
+  const MctsNode& root_node = (*pool)[root];
+  uint32_t best = root_node.first_child_;
+
+  for (uint32_t i = root_node.first_child_;
+       i < root_node.first_child_ + root_node.child_count_; ++i)
+  {
+    const MctsNode& child = (*pool)[i];
+    const MctsNode& best_child = (*pool)[best];
+
+    if (child.visits_ > best_child.visits_ ||
+        (child.visits_ == best_child.visits_ &&
+         child.points_ > best_child.points_))
+      best = i;
+  }
+
+  if (root_node.state_ == MctsNode::kExpanded)
+  {
+    const MctsNode& chosen = (*pool)[best];
+    double win_rate = chosen.points_ /
+                      double(kWinPoints * std::max(1u, chosen.visits_.load()));
+    int score = std::lround((2 * win_rate - 1) * CalcWinScore(board));
+
+    result.placement_ = {chosen.cell_ % width, chosen.cell_ / width};
+    result.score_ = player ? score : -score;
+  }
+  else
+  {
+    // The pool did not even have room for the moves of the root
+    unsigned short cells[tictactoe::kMaxCells];
+    PlayoutBoard(board).ListEmpty(cells);
+    result.placement_ = {cells[0] % width, cells[0] / width};
+  }
+
+  result.depth_ = total.max_depth_;
+  result.nodes_ = total.playouts_;
+
+#ifdef TICTACTOEAI_SEARCH_STATS
+  if (options.stats_)
+  {
+    options.stats_->nodes_ += total.playouts_;
+    options.stats_->expanded_ += total.expanded_;
+    options.stats_->leaves_ += total.playouts_;
+    options.stats_->max_ply_ = std::max(options.stats_->max_ply_,
+                                        total.max_depth_);
+    options.stats_->elapsed_ += std::chrono::steady_clock::now() - start;
+  }
+#endif
+
+  return result;
+}
@@ -0,0 +1,92 @@
+#ifndef MCTS_H_
+#define MCTS_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/******************************************************************************
+ *
+ * Nodes of the tree built by the Monte Carlo tree search
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Default number of nodes a pool has room for, about 20 MB
+  const size_t kDefaultMctsNodes = 1 << 20;
+
+  // A board in the tree, reached by placing a token on cell_
+  class MctsNode
+  {
+   public:
+    // Where the node is in building its children
+    enum State
+    {
+      kLeaf,
+      kExpanding,
+      kExpanded,
+
+      // The pool ran out of room, the node stays a leaf
+      kFull
+    };
+
+    // Playouts through the node, counted as soon as a playout starts so the
+    // other threads see it as a loss until its result is added (a virtual
+    // loss) and try other nodes
+    std::atomic<uint32_t> visits_{0};
+
+    // Results of the playouts through the node for the player who placed its
+    // token, 2 points for a win and 1 for a tie
+    std::atomic<uint32_t> points_{0};
+
+    // The children are the child_count_ nodes from first_child_ on, only set
+    // once state_ is kExpanded
+    uint32_t first_child_ = 0;
+    uint16_t child_count_ = 0;
+
+    uint16_t cell_ = 0;
+
+    std::atomic<uint8_t> state_{kLeaf};
+  };
+
+  // Fixed block of nodes handed out in runs, so the children of a node sit
+  // next to each other. Several threads can take nodes at once.
+  class MctsNodePool
+  {
+   public:
+    explicit MctsNodePool(size_t max_nodes = kDefaultMctsNodes);
+
+    MctsNodePool(const MctsNodePool&) = delete;
+    MctsNodePool& operator=(const MctsNodePool&) = delete;
+
+    bool Allocate(unsigned int count, uint32_t* first);
+    void Clear();
+
+    // Keeps only the subtree of a node of another pool, as the tree of the
+    // board after the node's move
+    void CopySubtree(const MctsNodePool& from, uint32_t node);
+
+    MctsNode& operator[](uint32_t index) { return nodes_[index]; }
+    const MctsNode& operator[](uint32_t index) const { return nodes_[index]; }
+
+    // Get pool info
+    size_t get_capacity() const { return capacity_; }
+    size_t get_used() const;
+
+   private:
+    // Nodes are only made when they are handed out, so a big pool costs
+    // nothing until it is used
+    std::unique_ptr<unsigned char[]> memory_;
+    MctsNode* nodes_;
+    size_t capacity_;
+    std::atomic<size_t> used_{0};
+  };
+}
+
+#endif  // MCTS_H_
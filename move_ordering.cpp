@@ -0,0 +1,145 @@
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+
+#include "move_ordering.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the MoveOrderer class
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Each move gets a 64 bit sort key. The heuristics fill the bits from the
+  // top down so an earlier heuristic always outranks a later one, and the
+  // bottom bits keep moves that tie in the order they were generated.
+  const uint64_t kHashMoveBit = uint64_t(1) << 60;
+  const uint64_t kWinBit = uint64_t(1) << 59;
+  const uint64_t kBlockBit = uint64_t(1) << 58;
+  const uint64_t kFirstKillerBit = uint64_t(1) << 57;
+  const uint64_t kSecondKillerBit = uint64_t(1) << 56;
+  const unsigned int kHistoryShift = 24;
+  const unsigned int kStaticShift = 12;
+  const uint64_t kIndexMask = 4095;
+}
+
+// Creates an orderer with nothing learned yet
+//
+// @param flags the MoveOrderingFlags to use
+tictactoeai::MoveOrderer::MoveOrderer(unsigned int flags) : flags_(flags)
+{
+  for (unsigned int ply = 0; ply < kMaxPly; ++ply)
+    killers_[ply][0] = killers_[ply][1] = tictactoe::kMaxCells;
+}
+
+// Sorts the moves of a board, best looking first. Moves that no heuristic
+// tells apart stay in the order they were given in.
+//
+// @param board the board the moves are for
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param ply how many moves the board is below the top root
+// @param hash_move the cell to try first, -1 for none
+// @param moves the cells of the moves, sorted in place
+// @param count the number of moves
+void tictactoeai::MoveOrderer::Order(const tictactoe::TicTacToe &board,
+                                     bool player, unsigned int ply,
+                                     int hash_move, unsigned short* moves,
+                                     unsigned int count) const
+{
+  if (flags_ == kOrderNone || count < 2)
+    return;
+
+  const tictactoe::BoardGeometry& geometry = board.get_geometry();
+  const unsigned int side = player ? 0 : 1;
+  const unsigned int threat = board.get_win_length() - 1;
+  ply = std::min(ply, kMaxPly - 1);
+
+  uint64_t keys[tictactoe::kMaxCells];
+  unsigned short cells[tictactoe::kMaxCells];
+
+  for (unsigned int i = 0; i < count; ++i)
+  {
+    unsigned int cell = moves[i];
+    uint64_t key = kIndexMask - i;
+
+    if ((flags_ & kOrderHashMove) && int(cell) == hash_move)
+      key |= kHashMoveBit;
+
+    if (flags_ & kOrderThreats)
+    {
+      for (const unsigned short* line = geometry.get_cell_lines_begin(cell);
+           line != geometry.get_cell_lines_end(cell); ++line)
+      {
+        unsigned int own = board.get_line_count(*line, player);
+        unsigned int other = board.get_line_count(*line, !player);
+
+        if (own == threat && other == 0)
+          key |= kWinBit;
+        else if (other == threat && own == 0)
+          key |= kBlockBit;
+      }
+    }
+
+    if (flags_ & kOrderKillers)
+    {
+      if (killers_[ply][0] == cell)
+        key |= kFirstKillerBit;
+      else if (killers_[ply][1] == cell)
+        key |= kSecondKillerBit;
+    }
+
+    if (flags_ & kOrderHistory)
+      key |= uint64_t(history_[side][cell]) << kHistoryShift;
+
+    if (flags_ & kOrderStatic)
+    {
+      uint64_t lines = geometry.get_cell_lines_end(cell) -
+                       geometry.get_cell_lines_begin(cell);
+      key |= std::min(lines, kIndexMask) << kStaticShift;
+    }
+
+    keys[i] = key;
+    cells[i] = cell;
+  }
+
+  std::sort(keys, keys + count, std::greater<uint64_t>());
+
+  for (unsigned int i = 0; i < count; ++i)
+    moves[i] = cells[kIndexMask - (keys[i] & kIndexMask)];
+}
+
+// Learns from a move that caused a cutoff
+//
+// @param player which players move it was, true for 'X' false for 'O'
+// @param ply how many moves the board was below the top root
+// @param cell the cell of the move
+// @param move_depth how many moves the board had left to look ahead, deeper
+//  cutoffs count for more
+void tictactoeai::MoveOrderer::UpdateOnCutoff(bool player, unsigned int ply,
+                                              unsigned int cell,
+                                              unsigned int move_depth)
+{
+  if (flags_ & kOrderKillers)
+  {
+    ply = std::min(ply, kMaxPly - 1);
+    if (killers_[ply][0] != cell)
+    {
+      killers_[ply][1] = killers_[ply][0];
+      killers_[ply][0] = cell;
+    }
+  }
+
+  if (flags_ & kOrderHistory)
+  {
+    // Kept well under 2^32 so the shifted value fits in the sort key
+    uint32_t& history = history_[player ? 0 : 1][cell];
+    history = std::min<uint32_t>(history + move_depth * move_depth,
+                                 0x0fffffff);
+  }
+}
@@ -0,0 +1,75 @@
+#ifndef MOVE_ORDERING_H_
+#define MOVE_ORDERING_H_
+
+#include <cstdint>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * Puts the moves of a board in the order the search should try them, best
+ * looking first, so alpha beta pruning cuts off sooner
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Heuristics the ordering can use, combined with |. Each one can be turned
+  // off to see what it is worth.
+  enum MoveOrderingFlags
+  {
+    kOrderNone = 0,
+
+    // The best move the transposition table has for the board, or the best
+    // move of the last iteration at the top root
+    kOrderHashMove = 1,
+
+    // Moves that win on the spot, then moves that stop the other player
+    // winning on their next move
+    kOrderThreats = 2,
+
+    // Moves that caused a cutoff at the same ply elsewhere in the tree
+    kOrderKillers = 4,
+
+    // Moves that caused cutoffs anywhere, weighted by how deep the cutoff was
+    kOrderHistory = 8,
+
+    // Cells on more lines first, the center then the corners on 3x3
+    kOrderStatic = 16,
+
+    kOrderAll = 31
+  };
+
+  // What a search thread has learned about which moves cause cutoffs
+  class MoveOrderer
+  {
+   public:
+    static const unsigned int kMaxPly = 64;
+
+    explicit MoveOrderer(unsigned int flags = kOrderAll);
+
+    void Order(const tictactoe::TicTacToe &board, bool player,
+               unsigned int ply, int hash_move, unsigned short* moves,
+               unsigned int count) const;
+
+    void UpdateOnCutoff(bool player, unsigned int ply, unsigned int cell,
+                        unsigned int move_depth);
+
+    unsigned int get_flags() const { return flags_; }
+
+   private:
+    unsigned int flags_;
+
+    // Two most recent cutoff moves at each ply, kMaxCells when there is none
+    unsigned short killers_[kMaxPly][2];
+
+    // Sum of the squared depths of the cutoffs each move caused, per player
+    uint32_t history_[2][tictactoe::kMaxCells] = {};
+  };
+}
+
+#endif  // MOVE_ORDERING_H_
@@ -0,0 +1,578 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include "batch_analyzer.h"
+#include "move_server.h"
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * File for serving move requests over a local socket
+ *
+ * Requests and answers are lines of text, so a server can be tried out with
+ * a tool such as nc:
+ *
+ *   $ nc -U /tmp/tictactoe.sock
+ *   X...O.X.. O
+ *   move=0,1 score=0 depth=6 nodes=0
+ *   time=200 size=15x15x5 ...
+ *   stats
+ *   requests=2 errors=0 cache_hits=0 coalesced=0 queue_depth=0 ...
+ *
+ * Settings in front of the position are size=WxHxK, depth=N, time=N in
+ * milliseconds, engine=minimax|mcts|auto|proof and iterations=N. Requests
+ * are answered the same way as batch lines, so a standard 3x3 board is
+ * answered from the solved table without searching unless the depth is
+ * too shallow to see the end of the game.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Reads the settings in front of the position of a request
+  //
+  // @param request the request line
+  // @param settings the settings to change, starting from the defaults
+  // @param line set to the rest of the request, the position
+  //
+  // @return an error record, empty when the settings were read
+  std::string ParseRequest(const std::string& request,
+                           tictactoeai::BatchSettings* settings,
+                           std::string* line)
+  {
+    size_t start = 0;
+
+    while (true)
+    {
+      size_t end = request.find(' ', start);
+      std::string word = request.substr(start, end - start);
+      size_t equals = word.find('=');
+      if (equals == std::string::npos)
+        break;
+
+      std::string name = word.substr(0, equals);
+      std::string value = word.substr(equals + 1);
+
+      if (name == "size")
+      {
+        unsigned int width, height, win_length;
+        char separator_1, separator_2;
+        std::istringstream size(value);
+
+        if (!(size >> width >> separator_1 >> height >> separator_2 >>
+              win_length))
+          return "error=bad size " + value;
+
+        settings->width_ = width;
+        settings->height_ = height;
+        settings->win_length_ = win_length;
+      }
+      else if (name == "depth")
+      {
+        settings->move_depth_ = std::stoi(value);
+        settings->time_budget_ = std::chrono::milliseconds(0);
+      }
+      else if (name == "time")
+        settings->time_budget_ = std::chrono::milliseconds(std::stoi(value));
+      else if (name == "engine")
+      {
+        if (value == "mcts")
+          settings->engine_ = tictactoeai::kEngineMcts;
+        else if (value == "auto")
+          settings->engine_ = tictactoeai::kEngineAuto;
+        else if (value == "proof")
+          settings->engine_ = tictactoeai::kEngineProof;
+        else
+          settings->engine_ = tictactoeai::kEngineMinimax;
+      }
+      else if (name == "iterations")
+        settings->mcts_iterations_ = std::stoi(value);
+      else
+        return "error=unknown setting " + name;
+
+      if (end == std::string::npos)
+      {
+        start = request.size();
+        break;
+      }
+      start = end + 1;
+    }
+
+    *line = request.substr(start);
+    return "";
+  }
+
+  // Writes the whole of a string to a socket
+  //
+  // @return false once the other end has gone away
+  bool SendAll(int connection, const std::string& text)
+  {
+    size_t sent = 0;
+    while (sent < text.size())
+    {
+      ssize_t count = send(connection, text.data() + sent, text.size() - sent,
+                           MSG_NOSIGNAL);
+      if (count <= 0)
+        return false;
+      sent += count;
+    }
+
+    return true;
+  }
+}
+
+// Counts a latency
+//
+// @param microseconds the latency
+void tictactoeai::LatencyHistogram::Add(uint64_t microseconds)
+{
+  buckets_[Bucket(microseconds)].fetch_add(1, std::memory_order_relaxed);
+  count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Finds a percentile of the latencies counted so far
+//
+// @param fraction the share of latencies at or under the result, such as
+//  0.99
+//
+// @return the top of the bucket the percentile falls in, 0 when nothing was
+//  counted
+uint64_t tictactoeai::LatencyHistogram::Percentile(double fraction) const
+{
+  uint64_t count = count_.load(std::memory_order_relaxed);
+  if (count == 0)
+    return 0;
+
+  uint64_t target = std::max<uint64_t>(1, uint64_t(fraction * count + 0.5));
+  uint64_t seen = 0;
+
+  for (unsigned int bucket = 0; bucket < kBuckets; ++bucket)
+  {
+    seen += buckets_[bucket].load(std::memory_order_relaxed);
+    if (seen >= target)
+      return BucketTop(bucket);
+  }
+
+  return BucketTop(kBuckets - 1);
+}
+
+// Gets the bucket of a latency, latencies under 4 get a bucket each and
+// every power of two above is split in four
+unsigned int tictactoeai::LatencyHistogram::Bucket(uint64_t microseconds)
+{
+  if (microseconds < 4)
+    return microseconds;
+
+  unsigned int power = 63 - __builtin_clzll(microseconds);
+  unsigned int quarter = (microseconds >> (power - 2)) & 3;
+  return 4 * (power - 1) + quarter;
+}
+
+// Gets the largest latency that falls in a bucket
+uint64_t tictactoeai::LatencyHistogram::BucketTop(unsigned int bucket)
+{
+  if (bucket < 4)
+    return bucket;
+
+  unsigned int power = bucket / 4 + 1;
+  uint64_t quarter = bucket % 4;
+  return ((4 + quarter + 1) << (power - 2)) - 1;
+}
+
+// Creates a server, it does not listen until Listen is called
+//
+// @param settings where to listen, the default search and the workers
+tictactoeai::MoveServer::MoveServer(const ServerSettings& settings)
+    : settings_(settings),
+      jobs_(std::max(1u, settings.defaults_.queue_size_))
+{
+  table_.Resize(settings_.defaults_.table_megabytes_);
+
+  unsigned int threads = settings_.defaults_.threads_;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  for (unsigned int i = 0; i < threads; ++i)
+    workers_.emplace_back(&MoveServer::RunWorker, this);
+}
+
+// Stops the server and waits for its threads
+tictactoeai::MoveServer::~MoveServer()
+{
+  Stop();
+
+  jobs_.Close();
+  for (unsigned int i = 0; i < workers_.size(); ++i)
+    workers_[i].join();
+}
+
+// Opens the socket of the server
+//
+// @param error set to what went wrong when the socket could not be opened
+//
+// @return whether the server is listening
+bool tictactoeai::MoveServer::Listen(std::string* error)
+{
+  if (!settings_.socket_path_.empty())
+  {
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+
+    if (settings_.socket_path_.size() >= sizeof(address.sun_path))
+    {
+      *error = "socket path is too long";
+      return false;
+    }
+    std::strcpy(address.sun_path, settings_.socket_path_.c_str());
+
+    // A socket file left behind by an earlier server would make bind fail
+    unlink(address.sun_path);
+
+    listener_ = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener_ < 0 ||
+        bind(listener_, reinterpret_cast<sockaddr*>(&address),
+             sizeof(address)) != 0 ||
+        listen(listener_, 64) != 0)
+    {
+      *error = std::string("could not listen on ") + address.sun_path + ": " +
+               std::strerror(errno);
+      return false;
+    }
+
+    return true;
+  }
+
+  sockaddr_in address;
+  std::memset(&address, 0, sizeof(address));
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(settings_.port_);
+
+  int reuse = 1;
+  listener_ = socket(AF_INET, SOCK_STREAM, 0);
+  if (listener_ >= 0)
+    setsockopt(listener_, SOL_SOCKET, SO_REUSEADDR, &reuse, sizeof(reuse));
+
+  socklen_t length = sizeof(address);
+  if (listener_ < 0 ||
+      bind(listener_, reinterpret_cast<sockaddr*>(&address),
+           sizeof(address)) != 0 ||
+      listen(listener_, 64) != 0 ||
+      getsockname(listener_, reinterpret_cast<sockaddr*>(&address),
+                  &length) != 0)
+  {
+    *error = "could not listen on port " + std::to_string(settings_.port_) +
+             ": " + std::strerror(errno);
+    return false;
+  }
+
+  port_ = ntohs(address.sin_port);
+  return true;
+}
+
+// Accepts connections until Stop is called, each one is served on a thread
+// of its own
+void tictactoeai::MoveServer::Run()
+{
+  while (!stopping_)
+  {
+    int connection = accept(listener_, NULL, NULL);
+    if (connection < 0)
+    {
+      if (errno == EINTR || errno == ECONNABORTED)
+        continue;
+      break;
+    }
+
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    if (stopping_)
+    {
+      close(connection);
+      break;
+    }
+
+    // A closed socket can come back from accept, so its old thread has to
+    // be joined first
+    for (int done : finished_)
+    {
+      connection_threads_[done].join();
+      connection_threads_.erase(done);
+    }
+    finished_.clear();
+
+    connections_.push_back(connection);
+    connection_threads_[connection] = std::thread(
+        &MoveServer::ServeConnection, this, connection);
+  }
+}
+
+// Stops accepting connections, closes the open ones and waits for their
+// threads. Requests already being searched are still answered.
+void tictactoeai::MoveServer::Stop()
+{
+  std::map<int, std::thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(connections_mutex_);
+    if (stopping_.exchange(true))
+      return;
+
+    // Wakes Run from accept and every connection from recv
+    if (listener_ >= 0)
+      shutdown(listener_, SHUT_RDWR);
+    for (int connection : connections_)
+      shutdown(connection, SHUT_RDWR);
+
+    threads.swap(connection_threads_);
+  }
+
+  for (std::pair<const int, std::thread>& thread : threads)
+    thread.second.join();
+
+  if (listener_ >= 0)
+    close(listener_);
+  if (!settings_.socket_path_.empty())
+    unlink(settings_.socket_path_.c_str());
+}
+
+// Answers one request, waiting for a worker to search it unless the same
+// fixed depth request was answered before or is being searched already
+//
+// @param request the request line, settings followed by a position
+//
+// @return the answer, without a newline
+std::string tictactoeai::MoveServer::Answer(const std::string& request)
+{
+  std::chrono::steady_clock::time_point start =
+   std::chrono::steady_clock::now();
+  ++requests_;
+
+  std::shared_ptr<Job> job(new Job);
+  job->settings_ = settings_.defaults_;
+
+  std::string answer;
+  try
+  {
+    answer = ParseRequest(request, &job->settings_, &job->line_);
+
+    // Throws here for a bad size instead of in a worker
+    if (answer.empty())
+      tictactoe::BoardGeometry::Get(job->settings_.width_,
+                                    job->settings_.height_,
+                                    job->settings_.win_length_);
+  }
+  catch (const std::exception& exception)
+  {
+    answer = std::string("error=") + exception.what();
+  }
+
+  if (answer.empty())
+  {
+    const BatchSettings& settings = job->settings_;
+    std::ostringstream key;
+    key << settings.width_ << "x" << settings.height_ << "x" <<
+     settings.win_length_ << " " << settings.move_depth_ << " " <<
+     settings.time_budget_.count() << " " << settings.engine_ << " " <<
+     settings.mcts_iterations_ << " " << job->line_;
+    job->key_ = key.str();
+
+    std::shared_future<std::string> pending;
+    bool searching = false;
+    {
+      std::lock_guard<std::mutex> lock(answers_mutex_);
+
+      std::unordered_map<std::string, std::string>::iterator cached =
+       cache_.find(job->key_);
+      if (cached != cache_.end())
+      {
+        ++cache_hits_;
+        answer = cached->second;
+      }
+      else
+      {
+        std::unordered_map<std::string,
+                           std::shared_future<std::string>>::iterator same =
+         pending_.find(job->key_);
+
+        if (same != pending_.end())
+        {
+          ++coalesced_;
+          pending = same->second;
+        }
+        else
+        {
+          pending = job->answer_.get_future().share();
+          pending_[job->key_] = pending;
+          searching = true;
+        }
+      }
+    }
+
+    if (searching)
+    {
+      uint64_t depth = ++queue_depth_;
+      uint64_t most = max_queue_depth_.load();
+      while (depth > most && !max_queue_depth_.compare_exchange_weak(most,
+                                                                     depth))
+        ;
+
+      jobs_.Push(job);
+    }
+
+    if (pending.valid())
+      answer = pending.get();
+  }
+
+  if (answer.compare(0, 6, "error=") == 0)
+    ++errors_;
+
+  latency_.Add(std::chrono::duration_cast<std::chrono::microseconds>(
+      std::chrono::steady_clock::now() - start).count());
+  return answer;
+}
+
+// Gets what the server has done so far
+//
+// @return the counts and latency percentiles
+tictactoeai::ServerStats tictactoeai::MoveServer::GetStats() const
+{
+  ServerStats stats;
+  stats.requests_ = requests_;
+  stats.errors_ = errors_;
+  stats.cache_hits_ = cache_hits_;
+  stats.coalesced_ = coalesced_;
+  stats.queue_depth_ = queue_depth_;
+  stats.max_queue_depth_ = max_queue_depth_;
+  stats.connections_ = open_connections_;
+  stats.p50_us_ = latency_.Percentile(0.5);
+  stats.p99_us_ = latency_.Percentile(0.99);
+  return stats;
+}
+
+// Formats the stats as the answer to a "stats" request
+//
+// @return the stats as key=value pairs, without a newline
+std::string tictactoeai::MoveServer::FormatStats() const
+{
+  ServerStats stats = GetStats();
+
+  std::ostringstream text;
+  text << "requests=" << stats.requests_ << " errors=" << stats.errors_ <<
+   " cache_hits=" << stats.cache_hits_ << " coalesced=" << stats.coalesced_ <<
+   " queue_depth=" << stats.queue_depth_ <<
+   " max_queue_depth=" << stats.max_queue_depth_ <<
+   " connections=" << stats.connections_ <<
+   " p50_us=" << stats.p50_us_ << " p99_us=" << stats.p99_us_;
+  return text.str();
+}
+
+// Reads request lines from a connection and writes the answers until the
+// other end closes it, sends "quit" or the server stops
+//
+// @param connection the socket of the connection
+void tictactoeai::MoveServer::ServeConnection(int connection)
+{
+  ++open_connections_;
+
+  std::string buffer;
+  char chunk[4096];
+  bool open = true;
+
+  while (open)
+  {
+    ssize_t count = recv(connection, chunk, sizeof(chunk), 0);
+    if (count <= 0)
+      break;
+    buffer.append(chunk, count);
+
+    size_t newline;
+    while (open && (newline = buffer.find('\n')) != std::string::npos)
+    {
+      std::string line = buffer.substr(0, newline);
+      buffer.erase(0, newline + 1);
+      if (!line.empty() && line.back() == '\r')
+        line.pop_back();
+
+      if (line.empty())
+        continue;
+      else if (line == "quit")
+        open = false;
+      else if (line == "stats")
+        open = SendAll(connection, FormatStats() + "\n");
+      else
+        open = SendAll(connection, Answer(line) + "\n");
+    }
+  }
+
+  --open_connections_;
+
+  std::lock_guard<std::mutex> lock(connections_mutex_);
+  connections_.erase(std::find(connections_.begin(), connections_.end(),
+                               connection));
+  finished_.push_back(connection);
+  close(connection);
+}
+
+// Searches requests from the queue until the server goes away
+void tictactoeai::MoveServer::RunWorker()
+{
+  std::shared_ptr<Job> job;
+
+  while (jobs_.Pop(&job))
+  {
+    --queue_depth_;
+
+    std::string answer;
+    try
+    {
+      answer = AnalyzeLine(job->line_, job->settings_, &table_);
+    }
+    catch (const std::exception& exception)
+    {
+      answer = std::string("error=") + exception.what();
+    }
+
+    {
+      std::lock_guard<std::mutex> lock(answers_mutex_);
+      pending_.erase(job->key_);
+
+      // Timed searches depend on how busy the machine is, so only fixed
+      // depth answers are worth keeping
+      if (settings_.cache_entries_ > 0 &&
+          job->settings_.time_budget_.count() == 0 &&
+          answer.compare(0, 6, "error=") != 0)
+      {
+        if (cache_.size() >= settings_.cache_entries_)
+          cache_.clear();
+        cache_[job->key_] = answer;
+      }
+    }
+
+    job->answer_.set_value(answer);
+    job.reset();
+  }
+}
@@ -0,0 +1,181 @@
+#ifndef MOVE_SERVER_H_
+#define MOVE_SERVER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <future>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "batch_analyzer.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * A long running process that answers move requests from other processes
+ * over a local socket, so they share one warm set of tables and threads
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Counts of latencies in buckets that grow with the latency, four to each
+  // power of two, so percentiles come out within a quarter of their value
+  class LatencyHistogram
+  {
+   public:
+    static const unsigned int kBuckets = 256;
+
+    void Add(uint64_t microseconds);
+
+    // Smallest latency at least the given fraction of all latencies are at
+    // or under, rounded up to the top of its bucket
+    uint64_t Percentile(double fraction) const;
+
+    uint64_t get_count() const { return count_; }
+
+   private:
+    static unsigned int Bucket(uint64_t microseconds);
+    static uint64_t BucketTop(unsigned int bucket);
+
+    std::atomic<uint64_t> buckets_[kBuckets] = {};
+    std::atomic<uint64_t> count_{0};
+  };
+
+  // Settings for a move server
+  class ServerSettings
+  {
+   public:
+    // Path of a Unix domain socket to listen on, empty to listen on TCP
+    std::string socket_path_;
+
+    // TCP port to listen on at 127.0.0.1 when there is no socket path, 0
+    // for any free port
+    unsigned int port_ = 7777;
+
+    // The board size and search every request gets unless it asks for
+    // another, the number of worker threads, the memory of the table they
+    // share and the most requests waiting for a worker
+    BatchSettings defaults_;
+
+    // Most answers to fixed depth requests kept to answer the same request
+    // again, 0 to keep none
+    size_t cache_entries_ = 65536;
+  };
+
+  // What a move server has done so far
+  class ServerStats
+  {
+   public:
+    uint64_t requests_ = 0;
+    uint64_t errors_ = 0;
+
+    // Requests answered from the cache, and requests that waited for the
+    // search of the same request from another connection
+    uint64_t cache_hits_ = 0;
+    uint64_t coalesced_ = 0;
+
+    // Requests waiting for a worker now and at most so far
+    uint64_t queue_depth_ = 0;
+    uint64_t max_queue_depth_ = 0;
+
+    unsigned int connections_ = 0;
+
+    // Time from reading a request to having its answer
+    uint64_t p50_us_ = 0;
+    uint64_t p99_us_ = 0;
+  };
+
+  // Answers requests one line at a time, a request is the position in the
+  // format of a batch line, optionally after settings of its own:
+  //
+  //   size=4x4x4 depth=6 X..O.XO...X..O.. X
+  //
+  // and the answer is the batch record for it. The line "stats" is answered
+  // with the ServerStats and "quit" closes the connection.
+  //
+  // Every connection gets a thread that reads its requests, and a fixed set
+  // of workers searches the requests of all connections from one queue with
+  // one transposition table. Board hashes include the board size, so
+  // requests of every size can share it.
+  class MoveServer
+  {
+   public:
+    explicit MoveServer(const ServerSettings& settings);
+    ~MoveServer();
+
+    MoveServer(const MoveServer&) = delete;
+    MoveServer& operator=(const MoveServer&) = delete;
+
+    bool Listen(std::string* error);
+    void Run();
+    void Stop();
+
+    // Answers one request line the way a connection would
+    std::string Answer(const std::string& request);
+
+    ServerStats GetStats() const;
+    std::string FormatStats() const;
+
+    unsigned int get_port() const { return port_; }
+
+   private:
+    // A request waiting for a worker, every connection that sent the same
+    // request waits for the same answer
+    class Job
+    {
+     public:
+      BatchSettings settings_;
+      std::string line_;
+      std::string key_;
+      std::promise<std::string> answer_;
+    };
+
+    void ServeConnection(int connection);
+    void RunWorker();
+
+    ServerSettings settings_;
+
+    int listener_ = -1;
+    unsigned int port_ = 0;
+    std::atomic<bool> stopping_{false};
+
+    BoundedQueue<std::shared_ptr<Job>> jobs_;
+    std::vector<std::thread> workers_;
+
+    // Connections still open, the threads serving connections by socket and
+    // the sockets of the threads that are done and can be joined
+    std::mutex connections_mutex_;
+    std::vector<int> connections_;
+    std::map<int, std::thread> connection_threads_;
+    std::vector<int> finished_;
+
+    TranspositionTable table_;
+
+    // Requests being searched and the answers to fixed depth requests
+    std::mutex answers_mutex_;
+    std::unordered_map<std::string, std::shared_future<std::string>> pending_;
+    std::unordered_map<std::string, std::string> cache_;
+
+    LatencyHistogram latency_;
+    std::atomic<uint64_t> requests_{0};
+    std::atomic<uint64_t> errors_{0};
+    std::atomic<uint64_t> cache_hits_{0};
+    std::atomic<uint64_t> coalesced_{0};
+    std::atomic<uint64_t> queue_depth_{0};
+    std::atomic<uint64_t> max_queue_depth_{0};
+    std::atomic<unsigned int> open_connections_{0};
+  };
+}
+
+#endif  // MOVE_SERVER_H_
@@ -0,0 +1,464 @@
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "opening_book.h"
+#include "proof_search.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * File for reading, writing and building opening books
+ *
+ * A book file is a 32 byte header followed by 16 byte entries sorted by key,
+ * then the packed board of each entry in the same order, in the byte order
+ * of the machine that wrote it:
+ *
+ *   magic "TTTBOOK1", version, width, height, win length, board bytes,
+ *    entry count
+ *   key, score, move, depth
+ *   ...
+ *   packed board
+ *   ...
+ *
+ * Positions are stored once for all their rotations and reflections, by the
+ * same canonical key the transposition table uses.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  const char kBookMagic[8] = {'T', 'T', 'T', 'B', 'O', 'O', 'K', '1'};
+  const uint32_t kBookVersion = 2;
+
+  class BookHeader
+  {
+   public:
+    char magic_[8];
+    uint32_t version_;
+    uint16_t width_;
+    uint16_t height_;
+    uint16_t win_length_;
+    uint16_t board_bytes_;
+    uint32_t reserved_32_;
+    uint64_t entry_count_;
+  };
+
+  static_assert(sizeof(BookHeader) == 32, "book headers are 32 bytes");
+  static_assert(sizeof(tictactoeai::BookEntry) == 16,
+                "book entries are 16 bytes");
+
+  // Table key a board is stored under in a book
+  uint64_t BookKey(const tictactoe::TicTacToe &board, bool player)
+  {
+    return tictactoeai::TranspositionTable::MakeKey(board.get_canonical_hash(),
+                                                    player);
+  }
+
+  // Packs the canonical form of a board, the rotation or reflection of it
+  // its canonical hash is of
+  std::vector<uint8_t> PackCanonicalBoard(const tictactoe::TicTacToe &board)
+  {
+    const tictactoe::BoardGeometry& geometry = board.get_geometry();
+    unsigned int symmetry = board.GetCanonicalSymmetry();
+    unsigned int width = board.get_width();
+
+    tictactoe::TicTacToe canonical(width, board.get_height(),
+                                   board.get_win_length());
+    for (unsigned int cell = 0; cell < geometry.get_cell_count(); ++cell)
+    {
+      char token = board.GetCell(cell % width, cell / width);
+      if (token == ' ')
+        continue;
+
+      unsigned int moved = geometry.get_symmetry_cell(symmetry, cell);
+      canonical.PlaceToken(token == 'X', moved % width, moved / width);
+    }
+
+    return tictactoe::PackBoard(canonical);
+  }
+}
+
+// Closes the book
+tictactoeai::OpeningBook::~OpeningBook()
+{
+  Close();
+}
+
+// Opens a book file and maps it into memory, closing any book already open
+//
+// @param path the book file
+// @param error set to what went wrong when the book could not be opened
+//
+// @return whether the book is open
+bool tictactoeai::OpeningBook::Open(const std::string& path,
+                                    std::string* error)
+{
+  Close();
+
+  int file = open(path.c_str(), O_RDONLY);
+  if (file < 0)
+  {
+    *error = "could not open " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  struct stat status;
+  if (fstat(file, &status) != 0 ||
+      size_t(status.st_size) < sizeof(BookHeader))
+  {
+    *error = path + " is not a book";
+    close(file);
+    return false;
+  }
+
+  size_t bytes = status.st_size;
+  void* mapping = mmap(NULL, bytes, PROT_READ, MAP_SHARED, file, 0);
+  close(file);
+
+  if (mapping == MAP_FAILED)
+  {
+    *error = "could not map " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  const BookHeader* header = static_cast<const BookHeader*>(mapping);
+  unsigned int cells = header->width_ * header->height_;
+  if (std::memcmp(header->magic_, kBookMagic, sizeof(kBookMagic)) != 0 ||
+      header->version_ != kBookVersion ||
+      header->board_bytes_ != 3 + (cells + 3) / 4 ||
+      bytes != sizeof(BookHeader) + header->entry_count_ *
+               (sizeof(BookEntry) + header->board_bytes_))
+  {
+    *error = path + " is not a book";
+    munmap(mapping, bytes);
+    return false;
+  }
+
+  // Lookups jump around the file, reading ahead would only waste memory
+  madvise(mapping, bytes, MADV_RANDOM);
+
+  mapping_ = mapping;
+  mapping_bytes_ = bytes;
+  entries_ = reinterpret_cast<const BookEntry*>(header + 1);
+  entry_count_ = header->entry_count_;
+  boards_ = reinterpret_cast<const uint8_t*>(entries_ + entry_count_);
+  board_bytes_ = header->board_bytes_;
+  width_ = header->width_;
+  height_ = header->height_;
+  win_length_ = header->win_length_;
+  return true;
+}
+
+// Unmaps the book, lookups then find nothing
+void tictactoeai::OpeningBook::Close()
+{
+  if (mapping_)
+    munmap(mapping_, mapping_bytes_);
+
+  mapping_ = NULL;
+  mapping_bytes_ = 0;
+  entries_ = NULL;
+  entry_count_ = 0;
+  boards_ = NULL;
+  board_bytes_ = 0;
+}
+
+// Looks a board up in the book. An entry whose key matches is only used
+// when its packed board is the board's canonical form.
+//
+// @param board the board to look up
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param result set to the move of the entry, its score and depth, with no
+//  nodes searched
+//
+// @return whether the board is in the book
+bool tictactoeai::OpeningBook::Lookup(const tictactoe::TicTacToe &board,
+                                      bool player, SearchResult* result) const
+{
+  if (!entries_ || board.get_width() != width_ ||
+      board.get_height() != height_ || board.get_win_length() != win_length_)
+    return false;
+
+  uint64_t key = BookKey(board, player);
+  const BookEntry* end = entries_ + entry_count_;
+  const BookEntry* entry = std::lower_bound(
+      entries_, end, key,
+      [](const BookEntry& entry, uint64_t key) { return entry.key_ < key; });
+
+  if (entry == end || entry->key_ != key)
+    return false;
+
+  std::vector<uint8_t> packed = PackCanonicalBoard(board);
+  if (packed.size() != board_bytes_ ||
+      std::memcmp(packed.data(), boards_ + (entry - entries_) * board_bytes_,
+                  board_bytes_) != 0)
+    return false;
+
+  // The move was stored on the canonical form of the board
+  const tictactoe::BoardGeometry& geometry = board.get_geometry();
+  unsigned int cell = geometry.get_symmetry_cell(
+      geometry.get_inverse_symmetry(board.GetCanonicalSymmetry()),
+      entry->move_);
+
+  if (board.GetCell(cell % width_, cell / width_) != ' ')
+    return false;
+
+  result->placement_ = {cell % width_, cell / width_};
+  result->score_ = entry->score_;
+  result->depth_ = entry->depth_;
+  result->nodes_ = 0;
+  return true;
+}
+
+// Makes the book record for the result of searching a board
+//
+// @param board the searched board
+// @param player which players turn it was, true for 'X' false for 'O'
+// @param result what the search found, it must have found a move
+//
+// @return the entry, with the move moved onto the canonical form of the
+//  board, and the packed canonical board
+tictactoeai::BookRecord tictactoeai::OpeningBook::MakeRecord(
+    const tictactoe::TicTacToe &board, bool player, const SearchResult& result)
+{
+  unsigned int cell = result.placement_.second * board.get_width() +
+                      result.placement_.first;
+
+  BookRecord record;
+  record.entry_.key_ = BookKey(board, player);
+  record.entry_.score_ = result.score_;
+  record.entry_.move_ = board.get_geometry().get_symmetry_cell(
+      board.GetCanonicalSymmetry(), cell);
+  record.entry_.depth_ = result.depth_;
+  record.board_ = PackCanonicalBoard(board);
+  return record;
+}
+
+// Writes a book file. When two records have the same key the deeper one is
+// kept.
+//
+// @param path the file to write
+// @param width the width of the boards of the book
+// @param height the height of the boards of the book
+// @param win_length the tokens in a row needed to win
+// @param records the records, in any order, with boards of the book's size
+// @param error set to what went wrong when the file could not be written
+//
+// @return whether the book was written
+bool tictactoeai::OpeningBook::Write(const std::string& path,
+                                     unsigned int width, unsigned int height,
+                                     unsigned int win_length,
+                                     std::vector<BookRecord> records,
+                                     std::string* error)
+{
+  std::sort(records.begin(), records.end(),
+            [](const BookRecord& a, const BookRecord& b) {
+              return a.entry_.key_ != b.entry_.key_ ?
+                     a.entry_.key_ < b.entry_.key_ :
+                     a.entry_.depth_ > b.entry_.depth_;
+            });
+  records.erase(std::unique(records.begin(), records.end(),
+                            [](const BookRecord& a, const BookRecord& b) {
+                              return a.entry_.key_ == b.entry_.key_;
+                            }),
+                records.end());
+
+  size_t board_bytes = 3 + (width * height + 3) / 4;
+  std::vector<BookEntry> entries;
+  std::vector<uint8_t> boards;
+  for (const BookRecord& record : records)
+  {
+    if (record.board_.size() != board_bytes)
+    {
+      *error = "book records must be of " + std::to_string(width) + "x" +
+               std::to_string(height) + " boards";
+      return false;
+    }
+
+    entries.push_back(record.entry_);
+    boards.insert(boards.end(), record.board_.begin(), record.board_.end());
+  }
+
+  BookHeader header;
+  std::memset(&header, 0, sizeof(header));
+  std::memcpy(header.magic_, kBookMagic, sizeof(kBookMagic));
+  header.version_ = kBookVersion;
+  header.width_ = width;
+  header.height_ = height;
+  header.win_length_ = win_length;
+  header.board_bytes_ = board_bytes;
+  header.entry_count_ = entries.size();
+
+  FILE* file = std::fopen(path.c_str(), "wb");
+  if (!file)
+  {
+    *error = "could not write " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  bool written =
+   std::fwrite(&header, sizeof(header), 1, file) == 1 &&
+   std::fwrite(entries.data(), sizeof(BookEntry), entries.size(), file) ==
+    entries.size() &&
+   std::fwrite(boards.data(), 1, boards.size(), file) == boards.size();
+
+  if (std::fclose(file) != 0 || !written)
+  {
+    *error = "could not write " + path + ": " + std::strerror(errno);
+    return false;
+  }
+
+  return true;
+}
+
+// Lists every position a game reaches in the opening plies, 'X' moving
+// first. Positions where the game is over have no move to store and are
+// left out.
+//
+// @param settings the board size and the opening plies
+//
+// @return the positions and the player to move in each
+std::vector<std::pair<tictactoe::TicTacToe, bool>>
+tictactoeai::ListBookPositions(const BookSettings& settings)
+{
+  std::vector<std::pair<tictactoe::TicTacToe, bool>> positions;
+  std::vector<tictactoe::TicTacToe> ply(
+      1, tictactoe::TicTacToe(settings.width_, settings.height_,
+                              settings.win_length_));
+  std::unordered_set<uint64_t> seen;
+  bool player = true;
+
+  for (unsigned int depth = 0; depth <= settings.opening_plies_ &&
+       !ply.empty(); ++depth)
+  {
+    std::vector<tictactoe::TicTacToe> next;
+
+    for (const tictactoe::TicTacToe& board : ply)
+    {
+      if (board.IsGameOver().first)
+        continue;
+
+      positions.push_back({board, player});
+      if (depth == settings.opening_plies_)
+        continue;
+
+      for (unsigned int y = 0; y < settings.height_; ++y)
+      {
+        for (unsigned int x = 0; x < settings.width_; ++x)
+        {
+          if (board.GetCell(x, y) != ' ')
+            continue;
+
+          tictactoe::TicTacToe child = board;
+          child.PlaceToken(player, x, y);
+          if (seen.insert(BookKey(child, !player)).second)
+            next.push_back(child);
+        }
+      }
+    }
+
+    ply.swap(next);
+    player = !player;
+  }
+
+  return positions;
+}
+
+// Searches positions for a book on several threads sharing one
+// transposition table
+//
+// @param positions the positions and the player to move in each
+// @param settings how to search and how many threads to search with
+//
+// @return a record for each position that has a move
+std::vector<tictactoeai::BookRecord> tictactoeai::SearchBookPositions(
+    const std::vector<std::pair<tictactoe::TicTacToe, bool>>& positions,
+    const BookSettings& settings)
+{
+  unsigned int threads = settings.threads_;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  TranspositionTable table;
+  table.Resize(settings.table_megabytes_);
+
+  std::vector<BookRecord> records(positions.size());
+  // One byte per position, the bits of a vector<bool> share words that the
+  // threads would write at once
+  std::vector<char> found(positions.size(), false);
+  std::atomic<size_t> next(0);
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; ++i)
+  {
+    workers.emplace_back([&]() {
+      // Proofs are not shared between threads, but each thread keeps its
+      // table so later positions reuse what earlier proofs found
+      std::unique_ptr<ProofTable> proof_table;
+      if (settings.engine_ == kEngineProof)
+      {
+        proof_table.reset(new ProofTable());
+        proof_table->Resize(settings.table_megabytes_);
+      }
+
+      SearchOptions options;
+      options.table_ = &table;
+      options.engine_ = settings.engine_;
+      options.proof_table_ = proof_table.get();
+
+      for (size_t index = next++; index < positions.size(); index = next++)
+      {
+        const tictactoe::TicTacToe& board = positions[index].first;
+        bool player = positions[index].second;
+
+        SearchResult result;
+        if (settings.time_budget_.count() > 0)
+          result = MakeTimedPlacementChoice(board, settings.time_budget_,
+                                            player, options);
+        else if (ChooseEngine(board, options) == kEngineProof)
+          result = ChoosePlacement(board, board.get_empty_spaces(), player,
+                                   options);
+        else
+        {
+          result = AnalyzePlacement(board, settings.move_depth_, player,
+                                    options);
+          result.depth_ = std::min(settings.move_depth_,
+                                   board.get_empty_spaces());
+        }
+
+        if (result.placement_.first != 100)
+          records[index] = OpeningBook::MakeRecord(board, player, result);
+        found[index] = result.placement_.first != 100;
+      }
+    });
+  }
+
+  for (unsigned int i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  std::vector<BookRecord> book;
+  for (size_t i = 0; i < records.size(); ++i)
+    if (found[i])
+      book.push_back(std::move(records[i]));
+
+  return book;
+}
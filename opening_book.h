@@ -0,0 +1,141 @@
+#ifndef OPENING_BOOK_H_
+#define OPENING_BOOK_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "tictactoe.h"
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ *
+ * Book of positions searched ahead of time, kept in a file that is mapped
+ * into memory so opening it costs nothing and every process reading the
+ * same book shares its pages
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // What the search found for one position, as it is stored in a book file
+  class BookEntry
+  {
+   public:
+    // Table key of the canonical form of the board with the player to move,
+    // see TranspositionTable::MakeKey. Entries are sorted by it.
+    uint64_t key_;
+
+    // Score of the move, positive when 'X' is winning
+    int32_t score_;
+
+    // Cell of the best move on the canonical form of the board
+    uint16_t move_;
+
+    // Moves the search looked ahead
+    uint16_t depth_;
+  };
+
+  // A book entry with the board it is for, as it is written to a book file
+  class BookRecord
+  {
+   public:
+    BookEntry entry_;
+
+    // Canonical form of the board packed with PackBoard, checked by lookups
+    // so a board whose key collides with the entry's is not answered
+    std::vector<uint8_t> board_;
+  };
+
+  // Settings for building a book
+  class BookSettings
+  {
+   public:
+    // Size of the board the book is for
+    unsigned int width_ = 3;
+    unsigned int height_ = 3;
+    unsigned int win_length_ = 3;
+
+    // Every position this many moves or fewer into a game goes in the book
+    unsigned int opening_plies_ = 4;
+
+    // How to search each position, to move_depth_ unless there is a time
+    // budget. With kEngineProof each position is proven to the end of the
+    // game instead.
+    unsigned int move_depth_ = 9;
+    std::chrono::milliseconds time_budget_{0};
+    SearchEngine engine_ = kEngineMinimax;
+
+    // Number of positions searched at once, 0 for one per core
+    unsigned int threads_ = 0;
+
+    // Memory of the transposition table the threads share, and of the proof
+    // table each thread keeps with kEngineProof
+    size_t table_megabytes_ = 64;
+  };
+
+  // A book file opened for reading. The entries are read straight from the
+  // mapped file, so the file must not change while it is open.
+  class OpeningBook
+  {
+   public:
+    OpeningBook() = default;
+    ~OpeningBook();
+
+    OpeningBook(const OpeningBook&) = delete;
+    OpeningBook& operator=(const OpeningBook&) = delete;
+
+    bool Open(const std::string& path, std::string* error);
+    void Close();
+
+    bool Lookup(const tictactoe::TicTacToe &board, bool player,
+                SearchResult* result) const;
+
+    // Book record for the result of searching a board
+    static BookRecord MakeRecord(const tictactoe::TicTacToe &board,
+                                 bool player, const SearchResult& result);
+
+    static bool Write(const std::string& path, unsigned int width,
+                      unsigned int height, unsigned int win_length,
+                      std::vector<BookRecord> records, std::string* error);
+
+    // Get book info
+    size_t get_size() const { return entry_count_; }
+    bool is_open() const { return mapping_ != NULL; }
+
+   private:
+    void* mapping_ = NULL;
+    size_t mapping_bytes_ = 0;
+
+    const BookEntry* entries_ = NULL;
+    size_t entry_count_ = 0;
+
+    // Packed boards of the entries, board_bytes_ each in the same order
+    const uint8_t* boards_ = NULL;
+    size_t board_bytes_ = 0;
+
+    unsigned int width_ = 0;
+    unsigned int height_ = 0;
+    unsigned int win_length_ = 0;
+  };
+
+  // Lists every position a game can reach in the opening plies of the
+  // settings, one for each set of symmetric positions, with the player to
+  // move
+  std::vector<std::pair<tictactoe::TicTacToe, bool>> ListBookPositions(
+      const BookSettings& settings);
+
+  // Searches positions for a book
+  std::vector<BookRecord> SearchBookPositions(
+      const std::vector<std::pair<tictactoe::TicTacToe, bool>>& positions,
+      const BookSettings& settings);
+}
+
+#endif  // OPENING_BOOK_H_
@@ -0,0 +1,350 @@
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "perfect_play_table.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the PerfectPlayTable class
+ *
+ * The table is solved backwards from the end of the game: positions with more
+ * tokens are solved first, so every position only has to look one move ahead
+ * at positions that are already solved.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Start of a saved table, followed by a version byte and one byte for each
+  // position
+  const char kFileMagic[4] = {'T', '3', 'P', 'P'};
+  const unsigned char kFileVersion = 1;
+
+  // Results stored in bits 4 and 5 of an entry
+  const unsigned char kUnknown = 0;
+  const unsigned char kXWins = 1;
+  const unsigned char kTie = 2;
+  const unsigned char kOWins = 3;
+
+  // Sum of 3^cell over the cells set in a 9 bit mask, so the index of a board
+  // is the value of the 'X' cells plus twice the value of the 'O' cells
+  unsigned int TernaryValue(unsigned int mask)
+  {
+    static const struct Values
+    {
+      unsigned int values[512];
+
+      Values()
+      {
+        for (unsigned int mask = 0; mask < 512; ++mask)
+        {
+          values[mask] = 0;
+          for (unsigned int cell = 0, power = 1; cell < 9; ++cell, power *= 3)
+            if (mask & (1 << cell))
+              values[mask] += power;
+        }
+      }
+    } values;
+
+    return values.values[mask];
+  }
+
+  // Writes out the board with the given index in the format the TicTacToe
+  // constructor reads
+  //
+  // @param board_index the index of the board, 0 to kBoards - 1
+  // @param state set to the 9 characters of the board
+  void DecodeBoard(unsigned int board_index, char* state)
+  {
+    const char tokens[3] = {' ', 'X', 'O'};
+
+    for (unsigned int cell = 0; cell < 9; ++cell, board_index /= 3)
+      state[cell] = tokens[board_index % 3];
+    state[9] = '\0';
+  }
+
+  // Points of a result for the given player, higher is better
+  int ResultPoints(unsigned char result, bool player)
+  {
+    if (result == kTie)
+      return 0;
+
+    return (result == kXWins) == player ? 1 : -1;
+  }
+}
+
+// Creates an empty table, Build or Load fills it
+tictactoeai::PerfectPlayTable::PerfectPlayTable()
+{
+  std::memset(entries_, 0, sizeof(entries_));
+}
+
+// Solves every position that can come up in a game where either player went
+// first
+//
+// A winning player picks the quickest win and a losing player the slowest
+// loss. Moves that are just as good are settled by the order the search
+// looks at them in, down each column in turn.
+void tictactoeai::PerfectPlayTable::Build()
+{
+  std::memset(entries_, 0, sizeof(entries_));
+
+  // Find the positions that can come up, starting from the empty board with
+  // either player to move
+  std::vector<bool> reachable(kPositions, false);
+  std::vector<unsigned int> pending = {0, 1};
+  std::vector<unsigned int> by_tokens[10];
+  reachable[0] = reachable[1] = true;
+
+  while (!pending.empty())
+  {
+    unsigned int position = pending.back();
+    pending.pop_back();
+
+    char state[10];
+    DecodeBoard(position / 2, state);
+    tictactoe::TicTacToe board(state);
+    bool player = position % 2 == 0;
+
+    by_tokens[9 - board.get_empty_spaces()].push_back(position);
+
+    if (board.IsGameOver().first)
+      continue;
+
+    for (unsigned int cell = 0; cell < 9; ++cell)
+    {
+      if (state[cell] != ' ')
+        continue;
+
+      tictactoe::TicTacToe child(board);
+      child.PlaceToken(player, cell % 3, cell / 3);
+
+      unsigned int next = Index(child, !player);
+      if (!reachable[next])
+      {
+        reachable[next] = true;
+        pending.push_back(next);
+      }
+    }
+  }
+
+  // Moves left until the game ends with perfect play
+  std::vector<unsigned char> distance(kPositions, 0);
+
+  for (unsigned int tokens = 10; tokens-- > 0;)
+  {
+    for (unsigned int position : by_tokens[tokens])
+    {
+      char state[10];
+      DecodeBoard(position / 2, state);
+      tictactoe::TicTacToe board(state);
+      bool player = position % 2 == 0;
+
+      std::pair<bool, char> game_over = board.IsGameOver();
+      if (game_over.first)
+      {
+        unsigned char result = kTie;
+        if (game_over.second == 'X')
+          result = kXWins;
+        else if (game_over.second == 'O')
+          result = kOWins;
+
+        entries_[position] = (result << 4) | kNoCell;
+        continue;
+      }
+
+      int best_next = -1;
+      unsigned char best_result = kUnknown;
+
+      // Down each column in turn, like the search
+      for (unsigned int i = 0; i < 3; ++i)
+      {
+        for (unsigned int j = 0; j < 3; ++j)
+        {
+          unsigned int cell = j * 3 + i;
+          if (state[cell] != ' ')
+            continue;
+
+          tictactoe::TicTacToe child(board);
+          child.PlaceToken(player, i, j);
+
+          unsigned int next = Index(child, !player);
+          unsigned char result = entries_[next] >> 4;
+
+          bool better = best_next < 0;
+          if (!better)
+          {
+            int points = ResultPoints(result, player);
+            int best_points = ResultPoints(best_result, player);
+
+            if (points != best_points)
+              better = points > best_points;
+            else if (points > 0)
+              better = distance[next] < distance[best_next];
+            else if (points < 0)
+              better = distance[next] > distance[best_next];
+          }
+
+          if (better)
+          {
+            best_next = next;
+            best_result = result;
+            entries_[position] = (result << 4) | cell;
+          }
+        }
+      }
+
+      distance[position] = distance[best_next] + 1;
+    }
+  }
+}
+
+// Writes the table to a file
+//
+// @param path the file to write
+//
+// @return whether the file could be written
+bool tictactoeai::PerfectPlayTable::Save(const std::string& path) const
+{
+  std::ofstream file(path, std::ios::binary);
+
+  file.write(kFileMagic, sizeof(kFileMagic));
+  file.put(kFileVersion);
+  file.write(reinterpret_cast<const char*>(entries_), sizeof(entries_));
+
+  return bool(file);
+}
+
+// Reads a table written by Save, the table is left as it was if the file is
+// not a saved table
+//
+// @param path the file to read
+//
+// @return whether the table could be read
+bool tictactoeai::PerfectPlayTable::Load(const std::string& path)
+{
+  std::ifstream file(path, std::ios::binary);
+
+  char magic[sizeof(kFileMagic)];
+  char version;
+  if (!file.read(magic, sizeof(magic)) || !file.get(version) ||
+      std::memcmp(magic, kFileMagic, sizeof(magic)) != 0 ||
+      (unsigned char)(version) != kFileVersion)
+    return false;
+
+  unsigned char entries[kPositions];
+  if (!file.read(reinterpret_cast<char*>(entries), sizeof(entries)) ||
+      file.peek() != std::ifstream::traits_type::eof())
+    return false;
+
+  std::memcpy(entries_, entries, sizeof(entries_));
+  return true;
+}
+
+// Looks up the best move
+//
+// @param board current tic-tac-toe board
+// @param player which players turn it is, true for 'X' false for 'O'
+//
+// @return the placement choice, {100, 100} when there is none in the table
+std::pair<unsigned int, unsigned int>
+tictactoeai::PerfectPlayTable::LookupBestMove(
+    const tictactoe::TicTacToe &board, bool player) const
+{
+  if (!IsStandardBoard(board))
+    return {100, 100};
+
+  unsigned int cell = entries_[Index(board, player)] & 15;
+  if (cell == kNoCell || (entries_[Index(board, player)] >> 4) == kUnknown)
+    return {100, 100};
+
+  return {cell % 3, cell / 3};
+}
+
+// Looks up who wins with perfect play
+//
+// @param board current tic-tac-toe board
+// @param player which players turn it is, true for 'X' false for 'O'
+//
+// @return 'X', 'O', ' ' for a tie or '?' when the position is not in the
+//  table
+char tictactoeai::PerfectPlayTable::LookupWinner(
+    const tictactoe::TicTacToe &board, bool player) const
+{
+  if (!IsStandardBoard(board))
+    return '?';
+
+  const char winners[4] = {'?', 'X', ' ', 'O'};
+  return winners[entries_[Index(board, player)] >> 4];
+}
+
+// Checks whether the table covers boards like the given one
+//
+// @param board the board to check
+//
+// @return whether the board is 3x3 with 3 in a row to win
+bool tictactoeai::PerfectPlayTable::IsStandardBoard(
+    const tictactoe::TicTacToe &board)
+{
+  return board.get_width() == 3 && board.get_height() == 3 &&
+         board.get_win_length() == 3;
+}
+
+// Gets the table shared by the whole program
+//
+// @return the table, solved the first time it is asked for
+const tictactoeai::PerfectPlayTable& tictactoeai::PerfectPlayTable::Get()
+{
+  static const struct Solved
+  {
+    PerfectPlayTable table;
+
+    Solved() { table.Build(); }
+  } solved;
+
+  return solved.table;
+}
+
+// Gets the position of a board in the table
+//
+// @param board a standard 3x3 board
+// @param player which players turn it is, true for 'X' false for 'O'
+//
+// @return the index of the entry for the position
+unsigned int tictactoeai::PerfectPlayTable::Index(
+    const tictactoe::TicTacToe &board, bool player)
+{
+  unsigned int x = board.get_x_bits().words_[0] & 511;
+  unsigned int o = board.get_o_bits().words_[0] & 511;
+
+  return (TernaryValue(x) + 2 * TernaryValue(o)) * 2 + (player ? 0 : 1);
+}
+
+// Works out whose turn it is from the number of tokens on the board
+//
+// @param board current tic-tac-toe board
+//
+// @return true for 'X' false for 'O'
+bool tictactoeai::SideToMove(const tictactoe::TicTacToe &board)
+{
+  return board.get_x_bits().Count() <= board.get_o_bits().Count();
+}
+
+// Looks up the best move for standard 3x3 tic-tac-toe, working out whose turn
+// it is from the number of tokens on the board
+//
+// @param board current tic-tac-toe board
+//
+// @return the placement choice, {100, 100} when there is none in the table
+std::pair<unsigned int, unsigned int> tictactoeai::LookupBestMove(
+    const tictactoe::TicTacToe &board)
+{
+  return PerfectPlayTable::Get().LookupBestMove(board, SideToMove(board));
+}
@@ -0,0 +1,74 @@
+#ifndef PERFECT_PLAY_TABLE_H_
+#define PERFECT_PLAY_TABLE_H_
+
+#include <string>
+#include <utility>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * Solved standard 3x3 tic-tac-toe, the best move and the result with perfect
+ * play for every position that can come up in a game
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  class PerfectPlayTable
+  {
+   public:
+    // Every way of filling the 9 cells with 'X', 'O' or ' '
+    static const unsigned int kBoards = 19683;
+
+    // Each board with either player to move
+    static const unsigned int kPositions = kBoards * 2;
+
+    // Cell stored for a position with no move to make
+    static const unsigned int kNoCell = 15;
+
+    // Creates an empty table, Build or Load fills it
+    PerfectPlayTable();
+
+    void Build();
+
+    // Compact binary form of the table, one byte per position
+    bool Save(const std::string& path) const;
+    bool Load(const std::string& path);
+
+    // Best move for the given player, {100, 100} when the board is not a
+    // standard 3x3 board, the game is over or the position can not come up
+    std::pair<unsigned int, unsigned int> LookupBestMove(
+        const tictactoe::TicTacToe &board, bool player) const;
+
+    // Who wins with perfect play, 'X', 'O', ' ' for a tie or '?' when the
+    // position is not in the table
+    char LookupWinner(const tictactoe::TicTacToe &board, bool player) const;
+
+    static bool IsStandardBoard(const tictactoe::TicTacToe &board);
+
+    // Table shared by the whole program, built the first time it is used
+    static const PerfectPlayTable& Get();
+
+   private:
+    static unsigned int Index(const tictactoe::TicTacToe &board, bool player);
+
+    // Low 4 bits are the best cell, the next 2 bits the result (0 when the
+    // position can not come up, then 'X' wins, tie, 'O' wins)
+    unsigned char entries_[kPositions];
+  };
+
+  // Which player moves next in a game where 'X' moved first, unless 'O'
+  // already has more tokens
+  bool SideToMove(const tictactoe::TicTacToe &board);
+
+  // Best move for standard 3x3 tic-tac-toe without searching
+  std::pair<unsigned int, unsigned int> LookupBestMove(
+      const tictactoe::TicTacToe &board);
+}
+
+#endif  // PERFECT_PLAY_TABLE_H_
@@ -1,61 +1,491 @@
-#include <iostream>
-#include <string>
-
-#include "tictactoe_ai.h"
-
-/******************************************************************************
- * 
- * Basic main file for playing against the tic-tac-toe A.I.
- * 
- * Example run: ./tictactoe.out
- * 
- * Author: Thomas Andrasek
- * 
- * Last updated: 2020/08/14
- * 
- * ***************************************************************************/
-
-int main() 
-{
-    tictactoe::TicTacToe board;
-
-    std::string input_text = "";
-
-    std::cout << "Enter A.I. move depth >> ";
-    std::cin >> input_text;
-    unsigned int move_depth = std::stoi(input_text);
-
-    std::cout << "Do you want to go first? y/n >> ";
-    std::cin >> input_text;
-    bool move_first = (input_text == "y") ? true : false;
-
-    int x = -1;
-    int y = -1;
-
-    while (!(board.IsGameOver().first))
-    {
-      if (move_first)
-      {
-        std::cout << "Enter a column number 0,1,2 >> ";
-        std::cin >> input_text;
-        x = std::stoi(input_text);
-        std::cout << "Enter a row number 0,1,2 >> ";
-        std::cin >> input_text;
-        y = std::stoi(input_text);
-        board.PlaceToken(move_first, x, y);
-      }
-      else
-      {
-        std::cout << "Thinking..." << std::endl;
-        std::pair<unsigned int, unsigned int> placement_choice =
-         tictactoeai::MakePlacementChoice(board, move_depth, move_first);
-        std::cout << "I'm going " << placement_choice.first << ", " <<
-         placement_choice.second << std::endl;
-        board.PlaceToken(move_first, placement_choice.first,
-                         placement_choice.second);
-      }
-
-      board.PrintBoard();
-      move_first = !move_first;
-    }
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "batch_analyzer.h"
+#include "game_session.h"
+#include "move_server.h"
+#include "opening_book.h"
+#include "tictactoe_ai.h"
+#include "tournament.h"
+
+/******************************************************************************
+ * 
+ * Basic main file for playing against the tic-tac-toe A.I.
+ * 
+ * Example run: ./tictactoe.out
+ * 
+ * A bigger board can be played by giving the width, height and how many in a
+ * row are needed to win, for example 15x15 with 5 in a row:
+ * 
+ *   ./tictactoe.out 15 15 5
+ * 
+ * Either can be followed by --book book.bin to play from an opening book.
+ * 
+ * Positions can be analyzed in bulk without playing, one per line from a file
+ * or from stdin, see batch_analyzer.cpp for the format:
+ * 
+ *   ./tictactoe.out --batch [--depth 9 | --time 500ms] [--threads 8]
+ *                   [--size 3 3 3] [--engine minimax|mcts|auto|proof]
+ *                   [--iterations 10000] [--hash 64] [positions.txt]
+ * 
+ * The a.i. can play itself, many games at once, to check that a change does
+ * not make it play worse. Options starting with --a- or --b- set one side,
+ * the same options without the side set both:
+ * 
+ *   ./tictactoe.out --selfplay [--games 1000] [--threads 8] [--size 3 3 3]
+ *                   [--openings 2] [--seed 1] [--hash 16]
+ *                   [--a-depth 9 | --a-time 50]
+ *                   [--a-engine minimax|mcts|auto|proof]
+ *                   [--a-iterations 10000] [--a-perfect-play]
+ * 
+ * It can also run as a server that answers move requests from other
+ * processes on a Unix domain socket or a localhost TCP port, see
+ * move_server.cpp for the requests:
+ * 
+ *   ./tictactoe.out --serve [--socket /tmp/tictactoe.sock | --port 7777]
+ *                   [--depth 9 | --time 500] [--threads 8] [--size 3 3 3]
+ *                   [--engine minimax|mcts|auto|proof] [--iterations 10000]
+ *                   [--hash 64] [--cache 65536]
+ * 
+ * Opening books are built by searching every position the given number of
+ * moves or fewer into a game, and any positions from a file in the format of
+ * the batch lines, see opening_book.cpp:
+ * 
+ *   ./tictactoe.out --build-book book.bin [--size 3 3 3] [--plies 4]
+ *                   [--depth 9 | --time 500] [--engine minimax|proof]
+ *                   [--threads 8] [--hash 64] [positions.txt]
+ * 
+ * With --engine proof every position is proven won, lost or tied, which
+ * makes an exact book.
+ * 
+ * Author: Thomas Andrasek
+ * 
+ * Last updated: 2026/10/18
+ * 
+ * ***************************************************************************/
+
+// Reads the search engine named on the command line
+//
+// @param name minimax, mcts, auto or proof
+//
+// @return the engine, minimax for any other name
+tictactoeai::SearchEngine ParseEngine(const std::string& name)
+{
+    if (name == "mcts")
+      return tictactoeai::kEngineMcts;
+    else if (name == "auto")
+      return tictactoeai::kEngineAuto;
+    else if (name == "proof")
+      return tictactoeai::kEngineProof;
+
+    return tictactoeai::kEngineMinimax;
+}
+
+// Analyzes positions in bulk with the settings from the command line
+//
+// @param argc the number of arguments
+// @param argv the arguments, starting with --batch
+//
+// @return the exit code of the program
+int RunBatch(int argc, char** argv)
+{
+    tictactoeai::BatchSettings settings;
+    std::string path = "";
+
+    for (int i = 2; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if (arg == "--depth" && i + 1 < argc)
+        settings.move_depth_ = std::stoi(argv[++i]);
+      else if (arg == "--time" && i + 1 < argc)
+        settings.time_budget_ = std::chrono::milliseconds(std::stoi(argv[++i]));
+      else if (arg == "--threads" && i + 1 < argc)
+        settings.threads_ = std::stoi(argv[++i]);
+      else if (arg == "--engine" && i + 1 < argc)
+        settings.engine_ = ParseEngine(argv[++i]);
+      else if (arg == "--iterations" && i + 1 < argc)
+        settings.mcts_iterations_ = std::stoi(argv[++i]);
+      else if (arg == "--hash" && i + 1 < argc)
+        settings.table_megabytes_ = std::stoul(argv[++i]);
+      else if (arg == "--size" && i + 3 < argc)
+      {
+        settings.width_ = std::stoi(argv[++i]);
+        settings.height_ = std::stoi(argv[++i]);
+        settings.win_length_ = std::stoi(argv[++i]);
+      }
+      else
+        path = arg;
+    }
+
+    if (path.empty())
+    {
+      tictactoeai::AnalyzeStream(std::cin, std::cout, settings);
+      return 0;
+    }
+
+    std::ifstream file(path);
+    if (!file)
+    {
+      std::cerr << "Could not open " << path << std::endl;
+      return 1;
+    }
+
+    tictactoeai::AnalyzeStream(file, std::cout, settings);
+    return 0;
+}
+
+// Sets one option of a side of a self-play tournament
+//
+// @param option the option without its dashes and side, such as depth
+// @param argc the number of arguments
+// @param argv the arguments
+// @param i the index of the option, moved past its value
+// @param side the side to set it for
+//
+// @return whether the option is one for a side
+bool ParseSideOption(const std::string& option, int argc, char** argv, int* i,
+                     tictactoeai::SideSettings* side)
+{
+    if (option == "perfect-play")
+      side->perfect_play_ = true;
+    else if (*i + 1 >= argc)
+      return false;
+    else if (option == "depth")
+      side->move_depth_ = std::stoi(argv[++*i]);
+    else if (option == "time")
+      side->time_budget_ = std::chrono::milliseconds(std::stoi(argv[++*i]));
+    else if (option == "engine")
+      side->engine_ = ParseEngine(argv[++*i]);
+    else if (option == "iterations")
+      side->mcts_iterations_ = std::stoi(argv[++*i]);
+    else
+      return false;
+
+    return true;
+}
+
+// Plays the a.i. against itself with the settings from the command line
+//
+// @param argc the number of arguments
+// @param argv the arguments, starting with --selfplay
+//
+// @return the exit code of the program
+int RunSelfPlay(int argc, char** argv)
+{
+    tictactoeai::TournamentSettings settings;
+
+    for (int i = 2; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if (arg == "--games" && i + 1 < argc)
+        settings.games_ = std::stoi(argv[++i]);
+      else if (arg == "--threads" && i + 1 < argc)
+        settings.threads_ = std::stoi(argv[++i]);
+      else if (arg == "--openings" && i + 1 < argc)
+        settings.opening_moves_ = std::stoi(argv[++i]);
+      else if (arg == "--seed" && i + 1 < argc)
+        settings.seed_ = std::stoull(argv[++i]);
+      else if (arg == "--hash" && i + 1 < argc)
+        settings.table_megabytes_ = std::stoul(argv[++i]);
+      else if (arg == "--size" && i + 3 < argc)
+      {
+        settings.width_ = std::stoi(argv[++i]);
+        settings.height_ = std::stoi(argv[++i]);
+        settings.win_length_ = std::stoi(argv[++i]);
+      }
+      else if (arg.compare(0, 4, "--a-") == 0 ||
+               arg.compare(0, 4, "--b-") == 0)
+      {
+        if (!ParseSideOption(arg.substr(4), argc, argv, &i,
+                             &settings.sides_[arg[2] - 'a']))
+        {
+          std::cerr << "Unknown option " << arg << std::endl;
+          return 1;
+        }
+      }
+      else
+      {
+        int first = i;
+        if (!ParseSideOption(arg.substr(2), argc, argv, &i,
+                             &settings.sides_[0]))
+        {
+          std::cerr << "Unknown option " << arg << std::endl;
+          return 1;
+        }
+
+        ParseSideOption(arg.substr(2), argc, argv, &first,
+                        &settings.sides_[1]);
+      }
+    }
+
+    tictactoeai::PrintTournamentReport(tictactoeai::RunTournament(settings),
+                                       std::cout);
+    return 0;
+}
+
+// Serves move requests with the settings from the command line until the
+// process is stopped
+//
+// @param argc the number of arguments
+// @param argv the arguments, starting with --serve
+//
+// @return the exit code of the program
+int RunServer(int argc, char** argv)
+{
+    tictactoeai::ServerSettings settings;
+    tictactoeai::BatchSettings& defaults = settings.defaults_;
+
+    for (int i = 2; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if (arg == "--socket" && i + 1 < argc)
+        settings.socket_path_ = argv[++i];
+      else if (arg == "--port" && i + 1 < argc)
+        settings.port_ = std::stoi(argv[++i]);
+      else if (arg == "--cache" && i + 1 < argc)
+        settings.cache_entries_ = std::stoul(argv[++i]);
+      else if (arg == "--depth" && i + 1 < argc)
+        defaults.move_depth_ = std::stoi(argv[++i]);
+      else if (arg == "--time" && i + 1 < argc)
+        defaults.time_budget_ = std::chrono::milliseconds(std::stoi(argv[++i]));
+      else if (arg == "--threads" && i + 1 < argc)
+        defaults.threads_ = std::stoi(argv[++i]);
+      else if (arg == "--engine" && i + 1 < argc)
+        defaults.engine_ = ParseEngine(argv[++i]);
+      else if (arg == "--iterations" && i + 1 < argc)
+        defaults.mcts_iterations_ = std::stoi(argv[++i]);
+      else if (arg == "--hash" && i + 1 < argc)
+        defaults.table_megabytes_ = std::stoul(argv[++i]);
+      else if (arg == "--size" && i + 3 < argc)
+      {
+        defaults.width_ = std::stoi(argv[++i]);
+        defaults.height_ = std::stoi(argv[++i]);
+        defaults.win_length_ = std::stoi(argv[++i]);
+      }
+      else
+      {
+        std::cerr << "Unknown option " << arg << std::endl;
+        return 1;
+      }
+    }
+
+    tictactoeai::MoveServer server(settings);
+    std::string error;
+    if (!server.Listen(&error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+
+    if (settings.socket_path_.empty())
+      std::cerr << "Listening on 127.0.0.1:" << server.get_port() << std::endl;
+    else
+      std::cerr << "Listening on " << settings.socket_path_ << std::endl;
+
+    server.Run();
+    return 0;
+}
+
+// Builds an opening book with the settings from the command line
+//
+// @param argc the number of arguments
+// @param argv the arguments, starting with --build-book and the book file
+//
+// @return the exit code of the program
+int RunBuildBook(int argc, char** argv)
+{
+    if (argc < 3)
+    {
+      std::cerr << "Missing the book file" << std::endl;
+      return 1;
+    }
+
+    std::string book_path = argv[2];
+    tictactoeai::BookSettings settings;
+    std::string path = "";
+
+    for (int i = 3; i < argc; ++i)
+    {
+      std::string arg = argv[i];
+
+      if (arg == "--plies" && i + 1 < argc)
+        settings.opening_plies_ = std::stoi(argv[++i]);
+      else if (arg == "--depth" && i + 1 < argc)
+        settings.move_depth_ = std::stoi(argv[++i]);
+      else if (arg == "--time" && i + 1 < argc)
+        settings.time_budget_ = std::chrono::milliseconds(std::stoi(argv[++i]));
+      else if (arg == "--engine" && i + 1 < argc)
+        settings.engine_ = ParseEngine(argv[++i]);
+      else if (arg == "--threads" && i + 1 < argc)
+        settings.threads_ = std::stoi(argv[++i]);
+      else if (arg == "--hash" && i + 1 < argc)
+        settings.table_megabytes_ = std::stoul(argv[++i]);
+      else if (arg == "--size" && i + 3 < argc)
+      {
+        settings.width_ = std::stoi(argv[++i]);
+        settings.height_ = std::stoi(argv[++i]);
+        settings.win_length_ = std::stoi(argv[++i]);
+      }
+      else
+        path = arg;
+    }
+
+    std::vector<std::pair<tictactoe::TicTacToe, bool>> positions =
+     tictactoeai::ListBookPositions(settings);
+
+    if (!path.empty())
+    {
+      std::ifstream file(path);
+      if (!file)
+      {
+        std::cerr << "Could not open " << path << std::endl;
+        return 1;
+      }
+
+      tictactoeai::BatchSettings batch_settings;
+      batch_settings.width_ = settings.width_;
+      batch_settings.height_ = settings.height_;
+      batch_settings.win_length_ = settings.win_length_;
+
+      std::string line;
+      while (std::getline(file, line))
+      {
+        tictactoe::TicTacToe board;
+        bool player;
+        std::string error = tictactoeai::ParseLine(line, batch_settings,
+                                                   &board, &player);
+        if (!error.empty())
+          std::cerr << error << std::endl;
+        else if (!board.IsGameOver().first)
+          positions.push_back({board, player});
+      }
+    }
+
+    std::vector<tictactoeai::BookRecord> records =
+     tictactoeai::SearchBookPositions(positions, settings);
+
+    std::string error;
+    if (!tictactoeai::OpeningBook::Write(book_path, settings.width_,
+                                         settings.height_,
+                                         settings.win_length_, records,
+                                         &error))
+    {
+      std::cerr << error << std::endl;
+      return 1;
+    }
+
+    std::cerr << "Wrote " << records.size() << " positions to " <<
+     book_path << std::endl;
+    return 0;
+}
+
+int main(int argc, char** argv) 
+{
+    if (argc > 1 && std::string(argv[1]) == "--batch")
+      return RunBatch(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "--selfplay")
+      return RunSelfPlay(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "--serve")
+      return RunServer(argc, argv);
+
+    if (argc > 1 && std::string(argv[1]) == "--build-book")
+      return RunBuildBook(argc, argv);
+
+    unsigned int width = 3;
+    unsigned int height = 3;
+    unsigned int win_length = 3;
+
+    tictactoeai::OpeningBook book;
+    tictactoeai::SearchOptions options;
+    if (argc > 2 && std::string(argv[argc - 2]) == "--book")
+    {
+      std::string error;
+      if (!book.Open(argv[argc - 1], &error))
+      {
+        std::cerr << error << std::endl;
+        return 1;
+      }
+
+      options.book_ = &book;
+      argc -= 2;
+    }
+
+    if (argc == 4)
+    {
+      width = std::stoi(argv[1]);
+      height = std::stoi(argv[2]);
+      win_length = std::stoi(argv[3]);
+    }
+
+    tictactoe::TicTacToe board(width, height, win_length);
+
+    std::string input_text = "";
+
+    // A depth such as 4, or a time limit per move such as 500ms
+    std::cout << "Enter A.I. move depth or time per move (e.g. 500ms) >> ";
+    std::cin >> input_text;
+    bool timed = input_text.size() > 2 &&
+                 input_text.compare(input_text.size() - 2, 2, "ms") == 0;
+    unsigned int move_depth = std::stoi(input_text);
+
+    std::cout << "Do you want to go first? y/n >> ";
+    std::cin >> input_text;
+    bool move_first = (input_text == "y") ? true : false;
+
+    // Kept for the whole game so later moves reuse earlier searches
+    tictactoeai::GameSession session(board, move_first, options);
+
+    int x = -1;
+    int y = -1;
+
+    while (!(session.get_board().IsGameOver().first))
+    {
+      if (move_first)
+      {
+        std::cout << "Enter a column number 0-" << width - 1 << " >> ";
+        std::cin >> input_text;
+        x = std::stoi(input_text);
+        std::cout << "Enter a row number 0-" << height - 1 << " >> ";
+        std::cin >> input_text;
+        y = std::stoi(input_text);
+        session.PlayMove(x, y);
+      }
+      else
+      {
+        std::cout << "Thinking..." << std::endl;
+        std::pair<unsigned int, unsigned int> placement_choice;
+
+        if (timed)
+        {
+          tictactoeai::SearchResult result = session.ChooseTimedMove(
+              std::chrono::milliseconds(move_depth));
+          std::cout << "Looked " << result.depth_ << " moves ahead" <<
+           std::endl;
+          placement_choice = result.placement_;
+        }
+        else
+        {
+          placement_choice = session.ChooseMove(move_depth);
+        }
+
+        std::cout << "I'm going " << placement_choice.first << ", " <<
+         placement_choice.second << std::endl;
+        session.PlayMove(placement_choice.first, placement_choice.second);
+
+        // Searches the likely replies while the player thinks
+        session.StartPondering();
+      }
+
+      session.get_board().PrintBoard();
+      move_first = !move_first;
+    }
 }
\ No newline at end of file
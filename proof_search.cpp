@@ -0,0 +1,639 @@
+#include <algorithm>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#include "proof_search.h"
+#include "tictactoe_ai.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * File for proving boards with depth first proof number search (df-pn)
+ *
+ * A proof asks one yes or no question, whether one player (the attacker)
+ * can force a win. Every board gets a proof number, the least number of
+ * boards still to prove to show the answer is yes, and a disproof number for
+ * no. Both are kept from the view of the player to move, so the proof number
+ * of a board is the least disproof number of its children and its disproof
+ * number is the sum of the proof numbers of its children. The search always
+ * goes down to the child that is cheapest to settle, with thresholds that
+ * send it back up once another child becomes cheaper.
+ *
+ * A tie is a no for the attacker, so proving a board takes up to two
+ * proofs: whether the player to move wins, and if not whether the other
+ * player does. When neither can it is a tie.
+ *
+ * Only the table remembers the tree. Boards that fall out of it are
+ * searched again when they are needed, so a proof fits in whatever memory
+ * the table is given and only gets slower when it is small.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Proof and disproof numbers this big are infinite. A board with a proof
+  // number of 0 is proven and its disproof number is infinite.
+  const uint32_t kInfinity = 0x7fffffff;
+
+  // Xored into the keys of the proof that the other player wins, so both
+  // proofs of a board can share the table
+  const uint64_t kDefenderKeySalt = 0x5851f42d4c957f2dULL;
+
+  // Adds two proof numbers, the sum is infinite only when one of them is
+  uint32_t AddNumbers(uint32_t a, uint32_t b)
+  {
+    if (a >= kInfinity || b >= kInfinity)
+      return kInfinity;
+
+    return std::min<uint64_t>(uint64_t(a) + b, kInfinity - 1);
+  }
+
+  // A move from a board being proven and the numbers of the board it leads to
+  class ProofChild
+  {
+   public:
+    unsigned short cell_;
+    uint32_t proof_;
+    uint32_t disproof_;
+  };
+
+  // Proves one board for one attacker at a time, placing and removing tokens
+  // on its own copy of the board
+  class Prover
+  {
+   public:
+    Prover(const tictactoe::TicTacToe &board, bool player,
+           const tictactoeai::ProofSettings& settings,
+           tictactoeai::ProofTable* table);
+
+    bool Prove(bool attacker, uint32_t* proof, uint32_t* disproof,
+               int* best_cell);
+
+    uint64_t get_nodes() const { return nodes_; }
+
+   private:
+    void Search(uint32_t max_proof, uint32_t max_disproof, uint32_t* proof,
+                uint32_t* disproof, int* best_cell);
+    bool ListMoves(std::vector<ProofChild>* children, uint32_t* proof,
+                   uint32_t* disproof, int* best_cell);
+    unsigned int FindWinningCells(bool player, unsigned short* cells) const;
+    uint64_t GetKey() const;
+    bool ShouldStop();
+
+    tictactoe::TicTacToe board_;
+    bool player_;
+    bool attacker_ = true;
+
+    const tictactoeai::ProofSettings& settings_;
+    tictactoeai::ProofTable* table_;
+
+    std::chrono::steady_clock::time_point deadline_;
+    bool has_deadline_ = false;
+    bool stopped_ = false;
+
+    // Moves of the board at each ply below the root
+    std::vector<std::vector<ProofChild>> plies_;
+    unsigned int ply_ = 0;
+
+    uint64_t nodes_ = 0;
+    uint64_t next_check_ = 0;
+  };
+
+  // Sets up a proof of a board that is not over yet
+  //
+  // @param board the board to prove
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param settings the limits of the proof
+  // @param table the table to prove with
+  Prover::Prover(const tictactoe::TicTacToe &board, bool player,
+                 const tictactoeai::ProofSettings& settings,
+                 tictactoeai::ProofTable* table)
+      : board_(board), player_(player), settings_(settings), table_(table),
+        plies_(board.get_empty_spaces() + 1)
+  {
+    if (settings.time_budget_.count() > 0)
+    {
+      deadline_ = std::chrono::steady_clock::now() + settings.time_budget_;
+      has_deadline_ = true;
+    }
+  }
+
+  // Proves whether the attacker can force a win from the board
+  //
+  // @param attacker the player to prove a win for, true for 'X'
+  // @param proof set to the proof number of the board from the view of the
+  //  player to move, 0 when they get what they want
+  // @param disproof set to the disproof number, 0 when they do not
+  // @param best_cell set to the move that gets the player to move what they
+  //  want, or the first move when nothing does
+  //
+  // @return false when the proof was stopped before it finished
+  bool Prover::Prove(bool attacker, uint32_t* proof, uint32_t* disproof,
+                     int* best_cell)
+  {
+    attacker_ = attacker;
+    Search(kInfinity, kInfinity, proof, disproof, best_cell);
+
+    return !stopped_ && (*proof == 0 || *disproof == 0);
+  }
+
+  // Searches the board until its numbers reach the thresholds
+  //
+  // What the player to move wants is a win when they are the attacker, and
+  // anything but a loss when they are not. The board is never over, the
+  // parent scores boards that are without searching them.
+  //
+  // @param max_proof the proof number to stop at
+  // @param max_disproof the disproof number to stop at
+  // @param proof set to the proof number of the board
+  // @param disproof set to the disproof number of the board
+  // @param best_cell set to the move with the least disproof number
+  void Prover::Search(uint32_t max_proof, uint32_t max_disproof,
+                      uint32_t* proof, uint32_t* disproof, int* best_cell)
+  {
+    ++nodes_;
+    uint64_t start_nodes = nodes_;
+    uint64_t key = GetKey();
+
+    std::vector<ProofChild>& children = plies_[ply_];
+    if (ListMoves(&children, proof, disproof, best_cell))
+    {
+      table_->Store(key, *proof, *disproof, 1);
+      return;
+    }
+
+    unsigned int width = board_.get_width();
+
+    while (true)
+    {
+      // The proof number is the least disproof number of the children and
+      // the disproof number the sum of their proof numbers
+      unsigned int best = 0;
+      uint32_t second_disproof = kInfinity;
+      *proof = kInfinity;
+      *disproof = 0;
+
+      for (unsigned int i = 0; i < children.size(); ++i)
+      {
+        *disproof = AddNumbers(*disproof, children[i].proof_);
+
+        if (children[i].disproof_ < *proof)
+        {
+          second_disproof = *proof;
+          *proof = children[i].disproof_;
+          best = i;
+        }
+        else if (children[i].disproof_ < second_disproof)
+          second_disproof = children[i].disproof_;
+      }
+
+      *best_cell = children[best].cell_;
+
+      if (*proof >= max_proof || *disproof >= max_disproof || ShouldStop())
+        break;
+
+      // The child's numbers swap places with the board's. It is searched
+      // until its disproof number passes the second best child, or a little
+      // past it, which saves going back and forth between two children
+      // that are about as hard (the 1 + epsilon trick).
+      ProofChild& child = children[best];
+      uint32_t child_max_proof = max_disproof >= kInfinity ? kInfinity :
+       max_disproof - *disproof + child.proof_;
+      uint32_t child_max_disproof = max_proof;
+      if (second_disproof < kInfinity)
+        child_max_disproof = std::min<uint64_t>(
+            max_proof, uint64_t(second_disproof) + 1 + second_disproof / 4);
+
+      board_.PlaceToken(player_, child.cell_ % width, child.cell_ / width);
+      player_ = !player_;
+      ++ply_;
+
+      int child_best;
+      Search(child_max_proof, child_max_disproof, &child.proof_,
+             &child.disproof_, &child_best);
+
+      --ply_;
+      player_ = !player_;
+      board_.RemoveToken(child.cell_ % width, child.cell_ / width);
+    }
+
+    table_->Store(key, *proof, *disproof, nodes_ - start_nodes + 1);
+  }
+
+  // Lists the moves of the board with the numbers of the boards they lead
+  // to. A player who can win on the spot, or who has to block two cells at
+  // once, settles the board without listing anything, and a player who has
+  // to block one cell only gets that move.
+  //
+  // @param children set to the moves
+  // @param proof set to the proof number when the board is settled
+  // @param disproof set to the disproof number when the board is settled
+  // @param best_cell set to the move that settles the board
+  //
+  // @return whether the board is settled without searching its moves
+  bool Prover::ListMoves(std::vector<ProofChild>* children, uint32_t* proof,
+                         uint32_t* disproof, int* best_cell)
+  {
+    children->clear();
+
+    unsigned short cells[tictactoe::kMaxCells];
+    if (FindWinningCells(player_, cells) > 0)
+    {
+      *proof = 0;
+      *disproof = kInfinity;
+      *best_cell = cells[0];
+      return true;
+    }
+
+    unsigned int threats = FindWinningCells(!player_, cells);
+    if (threats > 1)
+    {
+      *proof = kInfinity;
+      *disproof = 0;
+      *best_cell = cells[0];
+      return true;
+    }
+
+    const tictactoe::BoardGeometry& geometry = board_.get_geometry();
+    unsigned int width = board_.get_width();
+    unsigned int count = threats;
+
+    if (threats == 0)
+    {
+      // A move that a rotation or reflection of the board maps onto a move
+      // already listed leads to the same game
+      unsigned int symmetries[tictactoe::kMaxSymmetries];
+      unsigned int symmetry_count = 0;
+      for (unsigned int i = 1; i < geometry.get_symmetry_count(); ++i)
+        if (board_.IsSymmetric(i))
+          symmetries[symmetry_count++] = i;
+
+      tictactoe::Bitboard listed;
+      for (unsigned int cell = 0; cell < geometry.get_cell_count(); ++cell)
+      {
+        if (board_.GetCell(cell % width, cell / width) != ' ')
+          continue;
+
+        bool repeated = false;
+        for (unsigned int i = 0; !repeated && i < symmetry_count; ++i)
+          repeated = listed.Test(geometry.get_symmetry_cell(symmetries[i],
+                                                            cell));
+
+        if (!repeated)
+        {
+          listed.Set(cell);
+          cells[count++] = cell;
+        }
+      }
+    }
+
+    for (unsigned int i = 0; i < count; ++i)
+    {
+      ProofChild child = {cells[i], 1, 1};
+
+      board_.PlaceToken(player_, cells[i] % width, cells[i] / width);
+      std::pair<bool, char> over = board_.IsGameOver();
+
+      // A board that is over is worth nothing to the player to move on it,
+      // unless it is a tie and they are not the attacker
+      if (over.first && over.second == ' ' && !player_ != attacker_)
+      {
+        child.proof_ = 0;
+        child.disproof_ = kInfinity;
+      }
+      else if (over.first)
+      {
+        child.proof_ = kInfinity;
+        child.disproof_ = 0;
+      }
+      else
+      {
+        player_ = !player_;
+        table_->Lookup(GetKey(), &child.proof_, &child.disproof_);
+        player_ = !player_;
+      }
+
+      board_.RemoveToken(cells[i] % width, cells[i] / width);
+      children->push_back(child);
+    }
+
+    return false;
+  }
+
+  // Finds the empty cells that win the game for a player
+  //
+  // @param player true for 'X' false for 'O'
+  // @param cells set to the cells, must have room for every cell
+  //
+  // @return the number of cells, each listed once
+  unsigned int Prover::FindWinningCells(bool player,
+                                        unsigned short* cells) const
+  {
+    const tictactoe::BoardGeometry& geometry = board_.get_geometry();
+    unsigned int threat = board_.get_win_length() - 1;
+    unsigned int width = board_.get_width();
+    tictactoe::Bitboard found;
+    unsigned int count = 0;
+
+    for (unsigned int line = 0; line < geometry.get_line_count(); ++line)
+    {
+      if (board_.get_line_count(line, player) != threat ||
+          board_.get_line_count(line, !player) != 0)
+        continue;
+
+      const unsigned short* line_cells = geometry.get_line_cells(line);
+      for (unsigned int i = 0; i < board_.get_win_length(); ++i)
+      {
+        unsigned int cell = line_cells[i];
+        if (board_.GetCell(cell % width, cell / width) == ' ' &&
+            !found.Test(cell))
+        {
+          found.Set(cell);
+          cells[count++] = cell;
+        }
+      }
+    }
+
+    return count;
+  }
+
+  // Key of the board in the table, the same for every rotation and
+  // reflection of it
+  uint64_t Prover::GetKey() const
+  {
+    uint64_t key = tictactoeai::TranspositionTable::MakeKey(
+        board_.get_canonical_hash(), player_);
+    if (attacker_ != player_)
+      key ^= kDefenderKeySalt;
+
+    // 0 marks an empty entry
+    return key ? key : 1;
+  }
+
+  // Whether the proof has run out of nodes or time or been cancelled, the
+  // clock is only read every 1024 nodes
+  bool Prover::ShouldStop()
+  {
+    if (stopped_)
+      return true;
+
+    if (settings_.max_nodes_ > 0 && nodes_ >= settings_.max_nodes_)
+      stopped_ = true;
+    else if (nodes_ >= next_check_)
+    {
+      next_check_ = nodes_ + 1024;
+      stopped_ = (settings_.cancel_ && settings_.cancel_->load()) ||
+                 (has_deadline_ &&
+                  std::chrono::steady_clock::now() >= deadline_);
+    }
+
+    return stopped_;
+  }
+}
+
+// Frees entries allocated by Resize
+//
+// @param entries the entries to free
+void tictactoeai::ProofTable::FreeEntries::operator()(
+    ProofEntry* entries) const
+{
+  std::free(entries);
+}
+
+// Creates a table of about a megabyte
+tictactoeai::ProofTable::ProofTable()
+{
+  Resize(1);
+}
+
+// Finds the numbers of a board
+//
+// @param key the key of the board
+// @param proof set to the proof number when the board is found
+// @param disproof set to the disproof number when the board is found
+//
+// @return whether the board is in the table
+bool tictactoeai::ProofTable::Lookup(uint64_t key, uint32_t* proof,
+                                     uint32_t* disproof) const
+{
+  const ProofEntry* bucket =
+   &entries_[((key ^ (key >> 32)) & (bucket_count_ - 1)) *
+             kBucketEntries];
+
+  for (unsigned int i = 0; i < kBucketEntries; ++i)
+  {
+    if (bucket[i].key_ == key)
+    {
+      *proof = bucket[i].proof_;
+      *disproof = bucket[i].disproof_;
+      return true;
+    }
+  }
+
+  return false;
+}
+
+// Stores the numbers of a board. A board already in the table adds the work
+// to what it took before, a new one goes in an empty entry of its bucket or
+// over the entry that took the least work. Fills the table up to three
+// quarters before collecting it.
+//
+// @param key the key of the board, never 0
+// @param proof the proof number of the board
+// @param disproof the disproof number of the board
+// @param work the boards searched to find the numbers
+void tictactoeai::ProofTable::Store(uint64_t key, uint32_t proof,
+                                    uint32_t disproof, uint64_t work)
+{
+  ProofEntry* bucket =
+   &entries_[((key ^ (key >> 32)) & (bucket_count_ - 1)) *
+             kBucketEntries];
+  ProofEntry* entry = NULL;
+
+  for (unsigned int i = 0; i < kBucketEntries; ++i)
+  {
+    if (bucket[i].key_ == key)
+    {
+      work += bucket[i].work_;
+      entry = &bucket[i];
+      break;
+    }
+
+    if (!entry || bucket[i].work_ < entry->work_)
+      entry = &bucket[i];
+  }
+
+  if (entry->key_ == 0)
+    ++used_;
+
+  entry->key_ = key;
+  entry->proof_ = proof;
+  entry->disproof_ = disproof;
+  entry->work_ = std::max<uint64_t>(work, 1);
+
+  if (used_ * 4 >= get_size() * 3)
+    Collect();
+}
+
+// Resizes the table to the most buckets that fit in the given memory and
+// empties it. The memory is only touched as entries are stored.
+//
+// @param megabytes the memory the table may use, at least one bucket is kept
+void tictactoeai::ProofTable::Resize(size_t megabytes)
+{
+  size_t buckets =
+   megabytes * 1024 * 1024 / (sizeof(ProofEntry) * kBucketEntries);
+  bucket_count_ = 1;
+  while (bucket_count_ * 2 <= buckets)
+    bucket_count_ *= 2;
+
+  // Zeroed pages are handed out by the system as they are touched
+  void* memory = std::calloc(get_size(), sizeof(ProofEntry));
+  if (!memory)
+    throw std::bad_alloc();
+
+  entries_.reset(static_cast<ProofEntry*>(memory));
+  used_ = 0;
+}
+
+// Removes every entry from the table
+void tictactoeai::ProofTable::Clear()
+{
+  std::fill(entries_.get(), entries_.get() + get_size(), ProofEntry());
+  used_ = 0;
+}
+
+// Frees at least half of the table by removing the entries that took the
+// least work, which are the cheapest to search again. Proven boards go the
+// same way as any other, the boards above them keep their numbers.
+void tictactoeai::ProofTable::Collect()
+{
+  std::vector<uint64_t> work;
+  work.reserve(used_);
+  for (size_t i = 0; i < get_size(); ++i)
+    if (entries_[i].key_ != 0)
+      work.push_back(entries_[i].work_);
+
+  std::nth_element(work.begin(), work.begin() + work.size() / 2, work.end());
+  uint64_t median = work[work.size() / 2];
+
+  for (size_t i = 0; i < get_size(); ++i)
+  {
+    if (entries_[i].key_ != 0 && entries_[i].work_ <= median)
+    {
+      entries_[i] = ProofEntry();
+      --used_;
+    }
+  }
+
+  ++collections_;
+}
+
+// Proves what a board is worth to the player to move
+//
+// First proves whether the player to move can force a win. When they cannot
+// it proves whether the other player can, and when neither can the board is
+// a tie. A winning board comes with a winning move and a tied board with a
+// move that keeps the tie. A lost board comes with a move that at least
+// blocks an immediate win when there is one.
+//
+// @param board the board to prove
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param settings the limits of the proof and the memory of its table
+// @param table the table to prove with, kept between proofs so later ones
+//  reuse what earlier ones found. NULL for a table of its own.
+//
+// @return the value of the board, kProofUnknown when the proof stopped
+//  early, the move and the boards looked at
+tictactoeai::ProofResult tictactoeai::ProveBoard(
+    const tictactoe::TicTacToe &board, bool player,
+    const ProofSettings& settings, ProofTable* table)
+{
+  ProofResult result;
+
+  std::pair<bool, char> over = board.IsGameOver();
+  if (over.first)
+  {
+    if (over.second == ' ')
+      result.value_ = kProofDraw;
+    else
+      result.value_ = (over.second == 'X') == player ? kProofWin : kProofLoss;
+    return result;
+  }
+
+  std::unique_ptr<ProofTable> local_table;
+  if (!table)
+  {
+    local_table.reset(new ProofTable());
+    local_table->Resize(settings.table_megabytes_);
+    table = local_table.get();
+  }
+
+  uint64_t collections = table->get_collections();
+  Prover prover(board, player, settings, table);
+
+  uint32_t proof;
+  uint32_t disproof;
+  int best_cell = -1;
+
+  if (prover.Prove(player, &proof, &disproof, &best_cell))
+  {
+    if (proof == 0)
+      result.value_ = kProofWin;
+    else if (prover.Prove(!player, &proof, &disproof, &best_cell))
+      result.value_ = proof == 0 ? kProofDraw : kProofLoss;
+  }
+
+  if (result.value_ != kProofUnknown)
+    result.placement_ = {best_cell % board.get_width(),
+                         best_cell / board.get_width()};
+
+  result.nodes_ = prover.get_nodes();
+  result.collections_ = table->get_collections() - collections;
+  return result;
+}
+
+// Makes a placement choice with proof number search
+//
+// @param board current tic-tac-toe board
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the proof table, its memory and the most nodes to search
+// @param time_budget how long the proof may take, 0 or kNoTimeLimit for no
+//  time limit
+//
+// @return the placement choice scored as a win, loss or tie over the whole
+//  game, or no placement when the proof stopped before it finished
+tictactoeai::SearchResult tictactoeai::MakeProofPlacementChoice(
+    const tictactoe::TicTacToe &board,
+    bool player,
+    const SearchOptions &options,
+    std::chrono::milliseconds time_budget)
+{
+  ProofSettings settings;
+  settings.table_megabytes_ = options.proof_table_megabytes_;
+  settings.max_nodes_ = options.proof_max_nodes_;
+  settings.cancel_ = options.cancel_;
+  if (time_budget != kNoTimeLimit)
+    settings.time_budget_ = time_budget;
+
+  ProofResult proof = ProveBoard(board, player, settings,
+                                 options.proof_table_);
+
+  SearchResult result;
+  result.nodes_ = proof.nodes_;
+
+  if (proof.value_ == kProofUnknown || proof.placement_.first == 100)
+    return result;
+
+  int win = (player ? 1 : -1) * CalcWinScore(board);
+  result.placement_ = proof.placement_;
+  result.score_ = proof.value_ == kProofWin ? win :
+                  proof.value_ == kProofLoss ? -win : 0;
+  result.depth_ = board.get_empty_spaces();
+  return result;
+}
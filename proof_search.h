@@ -0,0 +1,128 @@
+#ifndef PROOF_SEARCH_H_
+#define PROOF_SEARCH_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ *
+ * Proof number search, which proves whether a board is won, lost or tied
+ * with perfect play instead of scoring it
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // What a board is worth to the player to move with perfect play
+  enum ProofValue
+  {
+    // The search stopped before it knew
+    kProofUnknown,
+    kProofWin,
+    kProofDraw,
+    kProofLoss
+  };
+
+  // Proof and disproof numbers of a board, stored by the work it took to
+  // find them
+  class ProofEntry
+  {
+   public:
+    uint64_t key_ = 0;
+    uint32_t proof_ = 0;
+    uint32_t disproof_ = 0;
+    uint64_t work_ = 0;
+  };
+
+  // Fixed size table of the boards a proof has looked at, which is all of
+  // the proof tree the search keeps. A full bucket gives way to the new
+  // board over the entry that took the least work, and once the table is
+  // three quarters full the half of it that took the least work is
+  // collected.
+  class ProofTable
+  {
+   public:
+    ProofTable();
+
+    ProofTable(const ProofTable&) = delete;
+    ProofTable& operator=(const ProofTable&) = delete;
+
+    bool Lookup(uint64_t key, uint32_t* proof, uint32_t* disproof) const;
+    void Store(uint64_t key, uint32_t proof, uint32_t disproof,
+               uint64_t work);
+
+    void Resize(size_t megabytes);
+    void Clear();
+    void Collect();
+
+    // Get table info
+    size_t get_size() const { return bucket_count_ * kBucketEntries; }
+    size_t get_used() const { return used_; }
+    uint64_t get_collections() const { return collections_; }
+
+   private:
+    static const unsigned int kBucketEntries = 4;
+
+    // The entries are allocated zeroed with calloc
+    class FreeEntries
+    {
+     public:
+      void operator()(ProofEntry* entries) const;
+    };
+
+    std::unique_ptr<ProofEntry[], FreeEntries> entries_;
+    size_t bucket_count_ = 0;
+    size_t used_ = 0;
+    uint64_t collections_ = 0;
+  };
+
+  // Settings for a proof
+  class ProofSettings
+  {
+   public:
+    // Memory of the table when the proof is not given one
+    size_t table_megabytes_ = 64;
+
+    // Most boards to look at before giving up, 0 for no limit
+    uint64_t max_nodes_ = 0;
+
+    // How long the proof may take, 0 for no time limit
+    std::chrono::milliseconds time_budget_{0};
+
+    // Set to true from another thread to stop the proof early, may be NULL
+    const std::atomic<bool>* cancel_ = NULL;
+  };
+
+  // What a proof found
+  class ProofResult
+  {
+   public:
+    ProofValue value_ = kProofUnknown;
+
+    // A move that keeps the value, a winning move of a won board or a move
+    // that holds the tie of a tied board. {100, 100} when the value is
+    // unknown or the game is over.
+    std::pair<unsigned int, unsigned int> placement_ = {100, 100};
+
+    // Boards looked at and times the table was collected
+    uint64_t nodes_ = 0;
+    uint64_t collections_ = 0;
+  };
+
+  // Proves what a board is worth to the player to move
+  ProofResult ProveBoard(const tictactoe::TicTacToe &board, bool player,
+                         const ProofSettings& settings,
+                         ProofTable* table = NULL);
+}
+
+#endif  // PROOF_SEARCH_H_
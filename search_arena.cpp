@@ -0,0 +1,118 @@
+#include <cstddef>
+#include <vector>
+
+#include "search_arena.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the SearchArena class
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+// Creates an empty arena, memory is only reserved on the first allocation
+//
+// @param block_size how many bytes to reserve at a time
+tictactoeai::SearchArena::SearchArena(size_t block_size)
+    : block_size_(block_size)
+{
+}
+
+// Frees every block the arena reserved
+tictactoeai::SearchArena::~SearchArena()
+{
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    delete [] blocks_[i].data_;
+}
+
+// Reserves memory from the arena, moving on to the next block (and making one
+// if needed) when the current block is too full
+//
+// @param size the number of bytes needed
+// @param alignment the alignment the memory needs, must be a power of two
+//
+// @return the start of the reserved memory
+void* tictactoeai::SearchArena::Allocate(size_t size, size_t alignment)
+{
+  while (true)
+  {
+    if (current_block_ < blocks_.size())
+    {
+      Block& block = blocks_[current_block_];
+      size_t start = (offset_ + alignment - 1) & ~(alignment - 1);
+
+      if (start + size <= block.size_)
+      {
+        used_bytes_ += start + size - offset_;
+        if (used_bytes_ > peak_bytes_)
+          peak_bytes_ = used_bytes_;
+
+        offset_ = start + size;
+        return block.data_ + start;
+      }
+
+      // Only move on when the next block is big enough, otherwise a bigger
+      // block is made in its place below
+      if (current_block_ + 1 < blocks_.size() &&
+          blocks_[current_block_ + 1].size_ >= size + alignment)
+      {
+        ++current_block_;
+        offset_ = 0;
+        continue;
+      }
+    }
+
+    size_t block_size = block_size_;
+    if (block_size < size + alignment)
+      block_size = size + alignment;
+
+    Block block = {new char[block_size], block_size};
+    size_t next = blocks_.empty() ? 0 : current_block_ + 1;
+    blocks_.insert(blocks_.begin() + next, block);
+    current_block_ = next;
+    offset_ = 0;
+  }
+}
+
+// Gets the current position of the arena
+//
+// @return a mark that Rewind can go back to
+tictactoeai::ArenaMark tictactoeai::SearchArena::Mark() const
+{
+  ArenaMark mark;
+  mark.block_ = current_block_;
+  mark.offset_ = offset_;
+  mark.used_ = used_bytes_;
+  return mark;
+}
+
+// Releases everything allocated since the mark was taken, the blocks are kept
+// for the next allocations
+//
+// @param mark a mark taken from this arena
+void tictactoeai::SearchArena::Rewind(const ArenaMark& mark)
+{
+  current_block_ = mark.block_;
+  offset_ = mark.offset_;
+  used_bytes_ = mark.used_;
+}
+
+// Releases everything in the arena, the blocks are kept for the next search
+void tictactoeai::SearchArena::Reset()
+{
+  Rewind(ArenaMark());
+}
+
+// Gets how much memory the arena is holding on to
+//
+// @return the total size of every block
+size_t tictactoeai::SearchArena::get_reserved_bytes() const
+{
+  size_t total = 0;
+  for (size_t i = 0; i < blocks_.size(); ++i)
+    total += blocks_[i].size_;
+  return total;
+}
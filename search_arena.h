@@ -0,0 +1,96 @@
+#ifndef SEARCH_ARENA_H_
+#define SEARCH_ARENA_H_
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/******************************************************************************
+ *
+ * Bump allocator for the nodes and boards made during a search
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Position in the arena that can be rewound to, everything allocated after
+  // the mark is released together
+  class ArenaMark
+  {
+   public:
+    size_t block_ = 0;
+    size_t offset_ = 0;
+    size_t used_ = 0;
+  };
+
+  class SearchArena
+  {
+   public:
+    explicit SearchArena(size_t block_size = 64 * 1024);
+    ~SearchArena();
+
+    SearchArena(const SearchArena&) = delete;
+    SearchArena& operator=(const SearchArena&) = delete;
+
+    void* Allocate(size_t size, size_t alignment);
+
+    // Makes an object in the arena, the destructor is never run so only types
+    // that do not need one can be made
+    template <typename T, typename... Args>
+    T* Create(Args&&... args)
+    {
+      static_assert(std::is_trivially_destructible<T>::value,
+                    "arena objects are never destroyed");
+      return new (Allocate(sizeof(T), alignof(T)))
+          T(std::forward<Args>(args)...);
+    }
+
+    // Makes an array of count default constructed objects in the arena
+    template <typename T>
+    T* CreateArray(size_t count)
+    {
+      static_assert(std::is_trivially_destructible<T>::value,
+                    "arena objects are never destroyed");
+      T* array = static_cast<T*>(Allocate(sizeof(T) * count, alignof(T)));
+      for (size_t i = 0; i < count; ++i)
+        new (array + i) T();
+      return array;
+    }
+
+    ArenaMark Mark() const;
+    void Rewind(const ArenaMark& mark);
+    void Reset();
+    void ResetPeak() { peak_bytes_ = used_bytes_; }
+
+    // Get arena info
+    size_t get_used_bytes() const { return used_bytes_; }
+    size_t get_peak_bytes() const { return peak_bytes_; }
+    size_t get_reserved_bytes() const;
+
+   private:
+    class Block
+    {
+     public:
+      char* data_;
+      size_t size_;
+    };
+
+    size_t block_size_;
+    std::vector<Block> blocks_;
+
+    // Block currently being allocated from and the offset into it
+    size_t current_block_ = 0;
+    size_t offset_ = 0;
+
+    size_t used_bytes_ = 0;
+    size_t peak_bytes_ = 0;
+  };
+}
+
+#endif  // SEARCH_ARENA_H_
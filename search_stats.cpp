@@ -0,0 +1,78 @@
+#include <algorithm>
+#include <cstdint>
+
+#include "search_stats.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the SearchStats class
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+// Sets every counter back to zero
+void tictactoeai::SearchStats::Clear()
+{
+  *this = SearchStats();
+}
+
+// Adds the counters of another set of stats, used to combine the stats of
+// the threads of a search
+//
+// @param other the stats to add
+void tictactoeai::SearchStats::Merge(const SearchStats& other)
+{
+  nodes_ += other.nodes_;
+  expanded_ += other.expanded_;
+  leaves_ += other.leaves_;
+  cutoffs_ += other.cutoffs_;
+
+  for (unsigned int i = 0; i < kMaxPly; ++i)
+    cutoffs_by_ply_[i] += other.cutoffs_by_ply_[i];
+  for (unsigned int i = 0; i < kMaxMoveIndex; ++i)
+    cutoffs_by_move_[i] += other.cutoffs_by_move_[i];
+
+  table_probes_ += other.table_probes_;
+  table_hits_ += other.table_hits_;
+  max_ply_ = std::max(max_ply_, other.max_ply_);
+  elapsed_ += other.elapsed_;
+}
+
+// Gets the effective branching factor, the branching factor b a uniform tree
+// as deep as the search would need to have as many nodes, so that
+// nodes = 1 + b + b^2 + ... + b^max_ply
+//
+// @return the branching factor, 0 when nothing past the root was searched
+double tictactoeai::SearchStats::GetEffectiveBranchingFactor() const
+{
+  if (max_ply_ == 0 || nodes_ <= 1)
+    return 0;
+
+  // The node count of a uniform tree only grows with b, so halve the range
+  // until it is small enough
+  double low = 0;
+  double high = nodes_;
+
+  for (unsigned int i = 0; i < 100; ++i)
+  {
+    double b = (low + high) / 2;
+    double total = 1;
+    double level = 1;
+
+    for (unsigned int ply = 0; ply < max_ply_ && total <= nodes_; ++ply)
+    {
+      level *= b;
+      total += level;
+    }
+
+    if (total > nodes_)
+      high = b;
+    else
+      low = b;
+  }
+
+  return low;
+}
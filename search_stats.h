@@ -0,0 +1,69 @@
+#ifndef SEARCH_STATS_H_
+#define SEARCH_STATS_H_
+
+#include <chrono>
+#include <cstdint>
+
+/******************************************************************************
+ *
+ * Counters describing how much work a search did
+ *
+ * The search only fills them in when the program is compiled with
+ * -DTICTACTOEAI_SEARCH_STATS, otherwise the code that counts is compiled out
+ * and the counters stay at zero.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+#ifdef TICTACTOEAI_SEARCH_STATS
+  const bool kSearchStatsEnabled = true;
+#else
+  const bool kSearchStatsEnabled = false;
+#endif
+
+  class SearchStats
+  {
+   public:
+    // Plies and move indexes past the last bucket are counted in the last one
+    static const unsigned int kMaxPly = 64;
+    static const unsigned int kMaxMoveIndex = 32;
+
+    // Boards visited, including ones answered by the table or scored as leaves
+    uint64_t nodes_ = 0;
+
+    // Boards whose moves were searched
+    uint64_t expanded_ = 0;
+
+    // Boards scored with EvaluateBoard because the search stopped there
+    uint64_t leaves_ = 0;
+
+    // Boards whose remaining moves were skipped by alpha beta pruning, by how
+    // far from the root they were and by which move caused it (0 is the
+    // first move searched)
+    uint64_t cutoffs_ = 0;
+    uint64_t cutoffs_by_ply_[kMaxPly] = {};
+    uint64_t cutoffs_by_move_[kMaxMoveIndex] = {};
+
+    // Transposition table lookups and the ones whose score was used
+    uint64_t table_probes_ = 0;
+    uint64_t table_hits_ = 0;
+
+    // Deepest ply visited, the root is ply 0
+    unsigned int max_ply_ = 0;
+
+    // Time spent in the searches that filled in the stats
+    std::chrono::nanoseconds elapsed_{0};
+
+    void Clear();
+    void Merge(const SearchStats& other);
+
+    double GetEffectiveBranchingFactor() const;
+  };
+}
+
+#endif  // SEARCH_STATS_H_
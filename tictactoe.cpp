@@ -1,233 +1,687 @@
-#include <iostream>
-#include <utility>
-#include <string>
-
-#include "tictactoe.h"
-
-/******************************************************************************
- * 
- * File for managing all the methods for the TicTacToe class
- * 
- * Author: Thomas Andrasek
- * 
- * Last updated: 2020/08/16
- * 
- * ***************************************************************************/
-
-// Default Constructor for the TicTacToe class
-//  
-// Creates a blank 3x3 tictactoe board object
-tictactoe::TicTacToe::TicTacToe()
-{
-  empty_spaces_ = 9;
-
-  board_data_ = new char*[widht_];
-  for (unsigned int i = 0; i < widht_; ++i)
-    board_data_[i] = new char[height_];
-
-  ClearBoard();
-}
-
-// Creates a TicTacToe object from the given character aray of 9 characters
-//
-// @param game_state game state of 9 characters
-tictactoe::TicTacToe::TicTacToe(const char* game_state)
-{
-  unsigned int count = 0;
-  for(unsigned int i = 0; i < 9; i++)
-    if(game_state[i] == ' ')
-      ++count;
-  empty_spaces_ = count;
-
-  board_data_ = new char*[3];
-
-  for (unsigned int i = 0; i < 3; ++i)
-    board_data_[i] = new char[3];
-
-  for (unsigned int j = 0; j < 3; ++j)
-    for (unsigned int i = 0; i < 3; ++i)
-      board_data_[i][j] = game_state[j*3+i];
-}
-
-// Copies the given TicTacToe object
-//  
-// @param board the TicTacToe board object to copy
-tictactoe::TicTacToe::TicTacToe(const TicTacToe& board)
-{
-  empty_spaces_ = board.get_empty_spaces();
-
-  board_data_ = new char*[widht_];
-
-  for (unsigned int i = 0; i < widht_; ++i)
-  {
-    board_data_[i] = new char[height_];
-    for (unsigned int j = 0; j < height_; ++j)
-      board_data_[i][j] = board.board_data_[i][j];
-  }
-}
-
-// Deconstructor for the TicTacToe object
-tictactoe::TicTacToe::~TicTacToe()
-{
-  for (unsigned int i = 0; i < widht_; ++i)
-    delete [] board_data_[i];
-
-  delete [] board_data_;
-}
-
-// Sets all the spots on the board to blank spots.
-void tictactoe::TicTacToe::ClearBoard()
-{
-  for (unsigned int i = 0; i < widht_; ++i)
-    for (unsigned int j = 0; j < height_; ++j)
-      board_data_[i][j] = ' ';
-}
-
-// Prints out the current board state.
-void tictactoe::TicTacToe::PrintBoard() const
-{
-  std::cout << " " << board_data_[0][2] << " | "
-   << board_data_[1][2] << " | " << board_data_[2][2] << std::endl;
-  std::cout << "-----------" << std::endl;
-  std::cout << " " << board_data_[0][1] << " | "
-   << board_data_[1][1] << " | " << board_data_[2][1] << std::endl;
-  std::cout << "-----------" << std::endl;
-  std::cout << " " << board_data_[0][0] << " | "
-   << board_data_[1][0] << " | " << board_data_[2][0] << std::endl;
-}
-
-// Places a token in the given position
-// 
-// @param player true for X false for O
-// @param x the column to place the token
-// @param y the row to place the token
-// 
-// @return whether the token could be placed
-bool tictactoe::TicTacToe::PlaceToken(bool player, unsigned int x,
-                                      unsigned int y)
-{
-  if (x >= 3 || y >= 3)
-    return false;
-
-  if (board_data_[x][y] == ' ')
-  {
-    if (player)
-      board_data_[x][y] = 'X';
-    else
-      board_data_[x][y] = 'O';
-
-    --empty_spaces_;
-
-    return true;
-  }
-
-  return false;
-}
-
-// Checks for if there is a winner.
-// 
-// @return whether there is a winner or not, if there is a winner the char of
-// the winner
-std::pair<bool, char> tictactoe::TicTacToe::CheckForWin() const 
-{
-  std::pair<bool, char> ret = {false, ' '};
-
-  if (board_data_[0][0] != ' '
-   && board_data_[0][0] == board_data_[1][0]
-   && board_data_[0][0] == board_data_[2][0])
-    ret = {true, board_data_[0][0]};
-  else if (board_data_[0][1] != ' '
-   && board_data_[0][1] == board_data_[1][1]
-   && board_data_[0][1] == board_data_[2][1])
-    ret = {true, board_data_[0][1]};
-  else if (board_data_[0][2] != ' '
-   && board_data_[0][2] == board_data_[1][2]
-   && board_data_[0][2] == board_data_[2][2])
-    ret = {true, board_data_[0][2]};
-  else if (board_data_[0][0] != ' '
-   && board_data_[0][0] == board_data_[0][1]
-   && board_data_[0][0] == board_data_[0][2])
-    ret = {true, board_data_[0][0]};
-  else if (board_data_[1][0] != ' '
-   && board_data_[1][0] == board_data_[1][1]
-   && board_data_[1][0] == board_data_[1][2])
-    ret = {true, board_data_[1][0]};
-  else if (board_data_[2][0] != ' '
-   && board_data_[2][0] == board_data_[2][1]
-   && board_data_[2][0] == board_data_[2][2])
-    ret = {true, board_data_[2][0]};
-  else if (board_data_[0][0] != ' '
-   && board_data_[0][0] == board_data_[1][1]
-   && board_data_[0][0] == board_data_[2][2])
-    ret = {true, board_data_[0][0]};
-  else if (board_data_[0][2] != ' '
-   && board_data_[0][2] == board_data_[1][1]
-   && board_data_[0][2] == board_data_[2][0])
-    ret = {true, board_data_[0][2]};
-
-  return ret;
-}
-
-// Check if the board is full
-// 
-// @return whether or not the board is full
-bool tictactoe::TicTacToe::IsBoardFull() const
-{
-  if (empty_spaces_ == 0)
-    return true;
-
-  return false;
-}
-
-// Checks if the tic-tac-toe game is over 
-// The game is over if: 
-//  - a player has three in a row 
-//  - the board is full
-//  
-// @return whether or not the game is over, if the game is over return the
-//  token of the winner, space character if tied
-std::pair<bool, char> tictactoe::TicTacToe::IsGameOver() const
-{
-  std::pair<bool, char> ret = CheckForWin();
-
-  if (ret.first)
-    return ret;
-  
-  if (IsBoardFull())
-    ret = {true, ' '};
-  
-  return ret;
-}
-
-// Have two players play a game of tic-tac-toe in the console
-void tictactoe::TicTacToe::PlayGame()
-{
-  bool player = true;
-  unsigned int x;
-  unsigned int y;
-
-  std::string temp = "";
-
-  std::pair<bool, char> game_over_data = IsGameOver();
-
-  PrintBoard();
-
-  while(!game_over_data.first)
-  {
-    std::cout << "Enter column >> ";
-    std::cin >> temp;
-    x = std::stoi(temp);
-
-    std::cout << "Enter row >> ";
-    std::cin >> temp;
-    y = std::stoi(temp);
-
-    PlaceToken(player, x, y);
-
-    player = !player;
-
-    game_over_data = IsGameOver();
-
-    PrintBoard();
-  }
-}
\ No newline at end of file
+#include <cstring>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <utility>
+
+#include "tictactoe.h"
+
+/******************************************************************************
+ * 
+ * File for managing all the methods for the TicTacToe class
+ * 
+ * Author: Thomas Andrasek
+ * 
+ * Last updated: 2026/10/18
+ * 
+ * ***************************************************************************/
+
+namespace
+{
+  // splitmix64, used to make the zobrist keys and the size hashes
+  uint64_t MixBits(uint64_t z)
+  {
+    z += 0x9e3779b97f4a7c15ULL;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+  // Points a line is worth, the tokens in it if only one player has any
+  //
+  // @param counts the number of 'X' and 'O' tokens in the line
+  //
+  // @return the points, positive for 'X'
+  int LineScore(const unsigned char* counts)
+  {
+    if (counts[1] == 0)
+      return counts[0];
+    if (counts[0] == 0)
+      return -counts[1];
+    return 0;
+  }
+}
+
+// Gets the shared line table for a board size, building it the first time
+// the size is used
+//
+// @param width the number of columns
+// @param height the number of rows
+// @param win_length the number of tokens in a row needed to win
+//
+// @return the line table for the size
+const tictactoe::BoardGeometry& tictactoe::BoardGeometry::Get(
+    unsigned int width, unsigned int height, unsigned int win_length)
+{
+  if (width == 0 || height == 0 || width * height > kMaxCells)
+    throw std::invalid_argument("board must have between 1 and " +
+                                std::to_string(kMaxCells) + " cells");
+  if (win_length == 0 || win_length > 255)
+    throw std::invalid_argument("win length must be between 1 and 255");
+
+  static std::mutex mutex;
+  static std::map<std::tuple<unsigned int, unsigned int, unsigned int>,
+                  std::unique_ptr<BoardGeometry>> geometries;
+
+  std::lock_guard<std::mutex> lock(mutex);
+  std::unique_ptr<BoardGeometry>& geometry =
+   geometries[std::make_tuple(width, height, win_length)];
+
+  if (!geometry)
+    geometry.reset(new BoardGeometry(width, height, win_length));
+
+  return *geometry;
+}
+
+// Builds every line of win_length cells on the board
+//
+// Lines are listed rows first, then columns, then the two diagonals, which is
+// the order CheckForWin has always reported winners in.
+//
+// @param width the number of columns
+// @param height the number of rows
+// @param win_length the number of tokens in a row needed to win
+tictactoe::BoardGeometry::BoardGeometry(unsigned int width,
+                                        unsigned int height,
+                                        unsigned int win_length)
+    : width_(width), height_(height), win_length_(win_length)
+{
+  const int steps[4][2] = {{1, 0}, {0, 1}, {1, 1}, {1, -1}};
+  const int k = win_length;
+
+  for (unsigned int direction = 0; direction < 4; ++direction)
+  {
+    int dx = steps[direction][0];
+    int dy = steps[direction][1];
+
+    // Rows are listed row by row and everything else column by column
+    unsigned int outer = direction == kRow ? height : width;
+    unsigned int inner = direction == kRow ? width : height;
+
+    for (unsigned int a = 0; a < outer; ++a)
+    {
+      for (unsigned int b = 0; b < inner; ++b)
+      {
+        int x = direction == kRow ? b : a;
+        int y = direction == kRow ? a : b;
+        int end_x = x + dx * (k - 1);
+        int end_y = y + dy * (k - 1);
+
+        if (end_x < 0 || end_x >= int(width) ||
+            end_y < 0 || end_y >= int(height))
+          continue;
+
+        Bitboard mask;
+        for (int i = 0; i < k; ++i)
+        {
+          unsigned int cell = (y + dy * i) * width + (x + dx * i);
+          mask.Set(cell);
+          line_cells_.push_back(cell);
+        }
+
+        line_masks_.push_back(mask);
+        line_directions_.push_back(Direction(direction));
+      }
+    }
+  }
+
+  // Index the lines by the cells they go through
+  std::vector<std::vector<unsigned short>> lines_by_cell(width * height);
+  for (unsigned int line = 0; line < line_masks_.size(); ++line)
+    for (int i = 0; i < k; ++i)
+      lines_by_cell[line_cells_[line * k + i]].push_back(line);
+
+  cell_line_starts_.push_back(0);
+  for (unsigned int cell = 0; cell < width * height; ++cell)
+  {
+    cell_lines_.insert(cell_lines_.end(), lines_by_cell[cell].begin(),
+                       lines_by_cell[cell].end());
+    cell_line_starts_.push_back(cell_lines_.size());
+  }
+
+  // Keeps get_cell_lines_begin valid for cells that are on no line
+  cell_lines_.push_back(0);
+
+  hash_seed_ = MixBits(MixBits(MixBits(width) ^ height) ^ win_length);
+
+  // Symmetry bit 0 mirrors the columns, bit 1 mirrors the rows and bit 2
+  // swaps the columns with the rows first, which only a square board can do.
+  // Every line is moved onto another line by each of them.
+  symmetry_count_ = width == height ? 8 : 4;
+  for (unsigned int symmetry = 0; symmetry < symmetry_count_; ++symmetry)
+  {
+    for (unsigned int cell = 0; cell < width * height; ++cell)
+    {
+      unsigned int x = cell % width;
+      unsigned int y = cell / width;
+
+      if (symmetry & 4)
+        std::swap(x, y);
+      if (symmetry & 1)
+        x = width - 1 - x;
+      if (symmetry & 2)
+        y = height - 1 - y;
+
+      symmetry_cells_.push_back(y * width + x);
+    }
+  }
+
+  for (unsigned int symmetry = 0; symmetry < symmetry_count_; ++symmetry)
+  {
+    for (unsigned int inverse = 0; inverse < symmetry_count_; ++inverse)
+    {
+      bool undoes = true;
+      for (unsigned int cell = 0; undoes && cell < width * height; ++cell)
+        undoes = get_symmetry_cell(inverse, get_symmetry_cell(symmetry, cell))
+                 == cell;
+
+      if (undoes)
+        inverse_symmetries_[symmetry] = inverse;
+    }
+  }
+
+  for (unsigned int symmetry = 0; symmetry < symmetry_count_; ++symmetry)
+    for (unsigned int cell = 0; cell < width * height; ++cell)
+      for (unsigned int side = 0; side < 2; ++side)
+        symmetry_keys_.push_back(
+            ZobristKey(get_symmetry_cell(symmetry, cell), side == 0));
+}
+
+// Random key for a token of the given player on the given cell
+//
+// The keys are generated once with splitmix64 from a fixed seed so hashes are
+// the same from run to run.
+//
+// @param cell the cell index, y * width + x
+// @param player true for X false for O
+//
+// @return the key to xor into the board hash
+uint64_t tictactoe::ZobristKey(unsigned int cell, bool player)
+{
+  static const struct Keys
+  {
+    uint64_t values[kMaxCells][2];
+
+    Keys()
+    {
+      for (unsigned int i = 0; i < kMaxCells; ++i)
+        for (unsigned int j = 0; j < 2; ++j)
+          values[i][j] = MixBits(i * 2 + j);
+    }
+  } keys;
+
+  return keys.values[cell][player ? 0 : 1];
+}
+
+// Default Constructor for the TicTacToe class
+//  
+// Creates a blank 3x3 tictactoe board object
+tictactoe::TicTacToe::TicTacToe() : TicTacToe(3, 3, 3)
+{
+}
+
+// Creates a blank board of any size
+//
+// @param width the number of columns
+// @param height the number of rows
+// @param win_length the number of tokens in a row needed to win
+tictactoe::TicTacToe::TicTacToe(unsigned int width, unsigned int height,
+                                unsigned int win_length)
+    : widht_(width), height_(height), win_length_(win_length),
+      geometry_(&BoardGeometry::Get(width, height, win_length))
+{
+  ClearBoard();
+}
+
+// Creates a TicTacToe object from the given character aray of 9 characters
+//
+// @param game_state game state of 9 characters
+tictactoe::TicTacToe::TicTacToe(const char* game_state)
+    : TicTacToe(game_state, 3, 3, 3)
+{
+}
+
+// Creates a board of any size from a character array of width * height
+// characters, row by row starting with the bottom row. 'X' and 'O' are tokens
+// and anything else is an empty spot.
+//
+// @param game_state game state of width * height characters
+// @param width the number of columns
+// @param height the number of rows
+// @param win_length the number of tokens in a row needed to win
+tictactoe::TicTacToe::TicTacToe(const char* game_state, unsigned int width,
+                                unsigned int height, unsigned int win_length)
+    : TicTacToe(width, height, win_length)
+{
+  for (unsigned int i = 0; i < widht_ * height_; ++i)
+  {
+    if (game_state[i] == 'X')
+    {
+      x_bits_.Set(i);
+      ToggleHashes(i, true);
+      --empty_spaces_;
+    }
+    else if (game_state[i] == 'O')
+    {
+      o_bits_.Set(i);
+      ToggleHashes(i, false);
+      --empty_spaces_;
+    }
+  }
+
+  for (unsigned int line = 0; line < geometry_->get_line_count(); ++line)
+  {
+    const Bitboard& mask = geometry_->get_line_mask(line);
+    line_counts_[line][0] = x_bits_.CountCommon(mask);
+    line_counts_[line][1] = o_bits_.CountCommon(mask);
+    line_score_ += LineScore(line_counts_[line]);
+
+    for (unsigned int side = 0; side < 2; ++side)
+    {
+      if (line_counts_[line][side] == win_length_)
+      {
+        ++winning_lines_[side];
+        if (winner_ == ' ')
+          winner_ = side == 0 ? 'X' : 'O';
+      }
+    }
+  }
+}
+
+// Copies the given TicTacToe object
+//
+// @param board the TicTacToe board object to copy
+tictactoe::TicTacToe::TicTacToe(const TicTacToe& board)
+{
+  CopyFrom(board);
+}
+
+// Copies the given TicTacToe object
+//
+// @param board the TicTacToe board object to copy
+//
+// @return this board
+tictactoe::TicTacToe& tictactoe::TicTacToe::operator=(const TicTacToe& board)
+{
+  if (this != &board)
+    CopyFrom(board);
+
+  return *this;
+}
+
+// Copies everything from the given board, only the line counts the board's
+// size uses are copied so small boards stay cheap to copy
+//
+// @param board the TicTacToe board object to copy
+void tictactoe::TicTacToe::CopyFrom(const TicTacToe& board)
+{
+  widht_ = board.widht_;
+  height_ = board.height_;
+  win_length_ = board.win_length_;
+  geometry_ = board.geometry_;
+  empty_spaces_ = board.empty_spaces_;
+  x_bits_ = board.x_bits_;
+  o_bits_ = board.o_bits_;
+  std::memcpy(hashes_, board.hashes_,
+              sizeof(hashes_[0]) * geometry_->get_symmetry_count());
+  winner_ = board.winner_;
+  line_score_ = board.line_score_;
+  winning_lines_[0] = board.winning_lines_[0];
+  winning_lines_[1] = board.winning_lines_[1];
+  std::memcpy(line_counts_, board.line_counts_,
+              sizeof(line_counts_[0]) * geometry_->get_line_count());
+}
+
+// Sets all the spots on the board to blank spots.
+void tictactoe::TicTacToe::ClearBoard()
+{
+  x_bits_ = Bitboard();
+  o_bits_ = Bitboard();
+  for (unsigned int i = 0; i < geometry_->get_symmetry_count(); ++i)
+    hashes_[i] = geometry_->get_hash_seed();
+  winner_ = ' ';
+  empty_spaces_ = widht_ * height_;
+  line_score_ = 0;
+  winning_lines_[0] = 0;
+  winning_lines_[1] = 0;
+  std::memset(line_counts_, 0,
+              sizeof(line_counts_[0]) * geometry_->get_line_count());
+}
+
+// Adds or removes the key of a token in the hash of every symmetry
+//
+// @param cell the cell of the token
+// @param player true for X false for O
+void tictactoe::TicTacToe::ToggleHashes(unsigned int cell, bool player)
+{
+  for (unsigned int i = 0; i < geometry_->get_symmetry_count(); ++i)
+    hashes_[i] ^= geometry_->get_symmetry_key(i, cell, player);
+}
+
+// Finds the symmetry that turns the board into its canonical form, the
+// rotation or reflection with the smallest hash. Every rotation and
+// reflection of a board has the same canonical form.
+//
+// @return the symmetry, the lowest one when several give the same hash
+unsigned int tictactoe::TicTacToe::GetCanonicalSymmetry() const
+{
+  unsigned int best = 0;
+
+  for (unsigned int i = 1; i < geometry_->get_symmetry_count(); ++i)
+    if (hashes_[i] < hashes_[best])
+      best = i;
+
+  return best;
+}
+
+// Checks whether a symmetry maps the board onto itself, so moves it maps
+// onto each other lead to the same game
+//
+// @param symmetry the symmetry to check
+//
+// @return whether every token lands on a token of the same player
+bool tictactoe::TicTacToe::IsSymmetric(unsigned int symmetry) const
+{
+  if (hashes_[symmetry] != hashes_[0])
+    return false;
+
+  for (unsigned int cell = 0; cell < widht_ * height_; ++cell)
+  {
+    unsigned int image = geometry_->get_symmetry_cell(symmetry, cell);
+    if (x_bits_.Test(cell) != x_bits_.Test(image) ||
+        o_bits_.Test(cell) != o_bits_.Test(image))
+      return false;
+  }
+
+  return true;
+}
+
+// Makes a rotated or reflected copy of the board
+//
+// @param symmetry the symmetry to apply, GetCanonicalSymmetry() gives the
+//  canonical form
+//
+// @return the transformed board, a token on cell c of this board is on
+//  get_symmetry_cell(symmetry, c) of the copy
+tictactoe::TicTacToe tictactoe::TicTacToe::Transform(
+    unsigned int symmetry) const
+{
+  TicTacToe board(widht_, height_, win_length_);
+
+  for (unsigned int cell = 0; cell < widht_ * height_; ++cell)
+  {
+    unsigned int image = geometry_->get_symmetry_cell(symmetry, cell);
+    if (x_bits_.Test(cell))
+      board.PlaceToken(true, image % widht_, image / widht_);
+    else if (o_bits_.Test(cell))
+      board.PlaceToken(false, image % widht_, image / widht_);
+  }
+
+  return board;
+}
+
+// Prints out the current board state, the top row first.
+void tictactoe::TicTacToe::PrintBoard() const
+{
+  for (unsigned int row = height_; row-- > 0;)
+  {
+    std::cout << " " << GetCell(0, row);
+    for (unsigned int column = 1; column < widht_; ++column)
+      std::cout << " | " << GetCell(column, row);
+    std::cout << std::endl;
+
+    if (row > 0)
+      std::cout << std::string(widht_ * 4 - 1, '-') << std::endl;
+  }
+}
+
+// Places a token in the given position
+// 
+// @param player true for X false for O
+// @param x the column to place the token
+// @param y the row to place the token
+// 
+// @return whether the token could be placed
+bool tictactoe::TicTacToe::PlaceToken(bool player, unsigned int x,
+                                      unsigned int y)
+{
+  if (x >= widht_ || y >= height_)
+    return false;
+
+  unsigned int cell = y * widht_ + x;
+
+  if (x_bits_.Test(cell) || o_bits_.Test(cell))
+    return false;
+
+  if (player)
+    x_bits_.Set(cell);
+  else
+    o_bits_.Set(cell);
+
+  ToggleHashes(cell, player);
+  --empty_spaces_;
+
+  // Only the lines through the new token change, and only they can have
+  // become a win
+  const unsigned int side = player ? 0 : 1;
+  for (const unsigned short* line = geometry_->get_cell_lines_begin(cell);
+       line != geometry_->get_cell_lines_end(cell); ++line)
+  {
+    unsigned char* counts = line_counts_[*line];
+
+    line_score_ -= LineScore(counts);
+    ++counts[side];
+    line_score_ += LineScore(counts);
+
+    if (counts[side] == win_length_)
+    {
+      ++winning_lines_[side];
+      if (winner_ == ' ')
+        winner_ = player ? 'X' : 'O';
+    }
+  }
+
+  return true;
+}
+
+// Removes the token in the given position, undoing PlaceToken so a search
+// can play moves on one board instead of copying it
+//
+// @param x the column of the token
+// @param y the row of the token
+//
+// @return whether there was a token to remove
+bool tictactoe::TicTacToe::RemoveToken(unsigned int x, unsigned int y)
+{
+  if (x >= widht_ || y >= height_)
+    return false;
+
+  unsigned int cell = y * widht_ + x;
+  bool player;
+
+  if (x_bits_.Test(cell))
+  {
+    player = true;
+    x_bits_.Reset(cell);
+  }
+  else if (o_bits_.Test(cell))
+  {
+    player = false;
+    o_bits_.Reset(cell);
+  }
+  else
+    return false;
+
+  ToggleHashes(cell, player);
+  ++empty_spaces_;
+
+  const unsigned int side = player ? 0 : 1;
+  for (const unsigned short* line = geometry_->get_cell_lines_begin(cell);
+       line != geometry_->get_cell_lines_end(cell); ++line)
+  {
+    unsigned char* counts = line_counts_[*line];
+
+    if (counts[side] == win_length_)
+      --winning_lines_[side];
+
+    line_score_ -= LineScore(counts);
+    --counts[side];
+    line_score_ += LineScore(counts);
+  }
+
+  // The winner only changes if their last full line was broken up
+  char token = player ? 'X' : 'O';
+  if (winner_ == token && winning_lines_[side] == 0)
+  {
+    if (winning_lines_[1 - side] > 0)
+      winner_ = player ? 'O' : 'X';
+    else
+      winner_ = ' ';
+  }
+
+  return true;
+}
+
+// Checks for if there is a winner.
+// 
+// @return whether there is a winner or not, if there is a winner the char of
+// the winner
+std::pair<bool, char> tictactoe::TicTacToe::CheckForWin() const 
+{
+  return {winner_ != ' ', winner_};
+}
+
+// Check if the board is full
+// 
+// @return whether or not the board is full
+bool tictactoe::TicTacToe::IsBoardFull() const
+{
+  if (empty_spaces_ == 0)
+    return true;
+
+  return false;
+}
+
+// Checks if the tic-tac-toe game is over 
+// The game is over if: 
+//  - a player has win_length in a row
+//  - the board is full
+//  
+// @return whether or not the game is over, if the game is over return the
+//  token of the winner, space character if tied
+std::pair<bool, char> tictactoe::TicTacToe::IsGameOver() const
+{
+  std::pair<bool, char> ret = CheckForWin();
+
+  if (ret.first)
+    return ret;
+  
+  if (IsBoardFull())
+    ret = {true, ' '};
+  
+  return ret;
+}
+
+// Have two players play a game of tic-tac-toe in the console
+void tictactoe::TicTacToe::PlayGame()
+{
+  bool player = true;
+  unsigned int x;
+  unsigned int y;
+
+  std::string temp = "";
+
+  std::pair<bool, char> game_over_data = IsGameOver();
+
+  PrintBoard();
+
+  while(!game_over_data.first)
+  {
+    std::cout << "Enter column >> ";
+    std::cin >> temp;
+    x = std::stoi(temp);
+
+    std::cout << "Enter row >> ";
+    std::cin >> temp;
+    y = std::stoi(temp);
+
+    PlaceToken(player, x, y);
+
+    player = !player;
+
+    game_over_data = IsGameOver();
+
+    PrintBoard();
+  }
+}
+
+// Packs a board into its compact binary form, the width and height less one
+// and the win length in a byte each, then 2 bits for each cell from the
+// first cell up, four cells to a byte starting with the low bits. An empty
+// cell is 0, 'X' is 1 and 'O' is 2, so a 3x3 board takes 6 bytes.
+//
+// @param board the board to pack
+//
+// @return the packed board
+std::vector<uint8_t> tictactoe::PackBoard(const TicTacToe &board)
+{
+  unsigned int cells = board.get_geometry().get_cell_count();
+  std::vector<uint8_t> packed(3 + (cells + 3) / 4, 0);
+
+  packed[0] = board.get_width() - 1;
+  packed[1] = board.get_height() - 1;
+  packed[2] = board.get_win_length();
+
+  for (unsigned int cell = 0; cell < cells; ++cell)
+  {
+    uint8_t code = 0;
+    if (board.get_x_bits().Test(cell))
+      code = 1;
+    else if (board.get_o_bits().Test(cell))
+      code = 2;
+
+    packed[3 + cell / 4] |= code << (cell % 4 * 2);
+  }
+
+  return packed;
+}
+
+// Unpacks a board packed with PackBoard
+//
+// @param data the packed board
+// @param size the number of bytes of the packed board
+// @param board set to the board
+//
+// @return false when the data is not a packed board
+bool tictactoe::UnpackBoard(const uint8_t* data, size_t size,
+                            TicTacToe* board)
+{
+  if (size < 3)
+    return false;
+
+  unsigned int width = data[0] + 1;
+  unsigned int height = data[1] + 1;
+  unsigned int win_length = data[2];
+  unsigned int cells = width * height;
+
+  if (cells > kMaxCells || win_length == 0 ||
+      size != 3 + (cells + 3) / 4)
+    return false;
+
+  TicTacToe unpacked(width, height, win_length);
+  for (unsigned int cell = 0; cell < cells; ++cell)
+  {
+    unsigned int code = (data[3 + cell / 4] >> (cell % 4 * 2)) & 3;
+    if (code == 3)
+      return false;
+    if (code != 0)
+      unpacked.PlaceToken(code == 1, cell % width, cell / width);
+  }
+
+  *board = unpacked;
+  return true;
+}
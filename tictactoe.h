@@ -1,53 +1,356 @@
-#include <utility>
-
-/******************************************************************************
- * General class for managing the game tic-tac-toe
- * 
- * Author: Thomas Andrasek
- * 
- * Last Updated: 2020/08/16
- * 
- * ***************************************************************************/
-
-namespace tictactoe
-{
-  class TicTacToe 
-  {
-   public:
-    // Constructors
-    TicTacToe();
-    TicTacToe(const char* game_state);
-    TicTacToe(const TicTacToe& board);
-
-    ~TicTacToe();
-
-    // Get game info
-    char** get_board_data() const { return board_data_; }
-    unsigned int get_width() const { return widht_; }
-    unsigned int get_height() const { return height_; }
-    unsigned int get_empty_spaces() const { return empty_spaces_; }
-
-    void ClearBoard();
-
-    // Plays game between two players
-    void PlayGame();
-
-    bool PlaceToken(bool player, unsigned int x, unsigned int y);
-
-    // Check board states
-    std::pair<bool, char> CheckForWin() const;
-    std::pair<bool, char> IsGameOver() const;
-    bool IsBoardFull() const;
-
-    void PrintBoard() const;
-
-   private:
-    // Size of board
-    unsigned int widht_ = 3;
-    unsigned int height_ = 3;
-
-    unsigned int empty_spaces_;
-
-    char** board_data_;
-  };
-}
\ No newline at end of file
+#ifndef TICTACTOE_H_
+#define TICTACTOE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/******************************************************************************
+ * General class for managing the game tic-tac-toe
+ *
+ * Boards can be any width and height up to kMaxCells cells, and a player wins
+ * with win_length tokens in a row, column or diagonal (an m,n,k-game).
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last Updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoe
+{
+  // Largest number of cells a board can have
+  const unsigned int kMaxCells = 256;
+
+  // Largest number of lines a board can have, each cell starts at most one
+  // line in each of the four directions
+  const unsigned int kMaxLines = kMaxCells * 4;
+
+  // Rotations and reflections of a square board, a board that is not square
+  // only has the first four
+  const unsigned int kMaxSymmetries = 8;
+
+  // One bit per cell, the cell at column x and row y is bit (y * width + x)
+  class Bitboard
+  {
+   public:
+    static const unsigned int kWords = kMaxCells / 64;
+
+    uint64_t words_[kWords] = {};
+
+    bool Test(unsigned int cell) const
+    {
+      return (words_[cell >> 6] >> (cell & 63)) & 1;
+    }
+
+    void Set(unsigned int cell)
+    {
+      words_[cell >> 6] |= uint64_t(1) << (cell & 63);
+    }
+
+    void Reset(unsigned int cell)
+    {
+      words_[cell >> 6] &= ~(uint64_t(1) << (cell & 63));
+    }
+
+    bool Any() const
+    {
+      for (unsigned int i = 0; i < kWords; ++i)
+        if (words_[i])
+          return true;
+      return false;
+    }
+
+    // Whether any cell is set in both bitboards
+    bool Intersects(const Bitboard& other) const
+    {
+      for (unsigned int i = 0; i < kWords; ++i)
+        if (words_[i] & other.words_[i])
+          return true;
+      return false;
+    }
+
+    // Whether every cell set in other is also set in this bitboard
+    bool Contains(const Bitboard& other) const
+    {
+      for (unsigned int i = 0; i < kWords; ++i)
+        if ((words_[i] & other.words_[i]) != other.words_[i])
+          return false;
+      return true;
+    }
+
+    // Number of cells set in both bitboards
+    unsigned int CountCommon(const Bitboard& other) const
+    {
+      unsigned int count = 0;
+      for (unsigned int i = 0; i < kWords; ++i)
+        count += __builtin_popcountll(words_[i] & other.words_[i]);
+      return count;
+    }
+
+    unsigned int Count() const { return CountCommon(*this); }
+  };
+
+  // Every line of win_length cells on a board of the given size. The table
+  // for each size is built once and shared by every board of that size.
+  class BoardGeometry
+  {
+   public:
+    // Directions a line can run in
+    enum Direction
+    {
+      kRow,
+      kColumn,
+      kRightDiagonal,  // up and to the right, like (0,0) (1,1) (2,2)
+      kLeftDiagonal    // down and to the right, like (0,2) (1,1) (2,0)
+    };
+
+    static const BoardGeometry& Get(unsigned int width, unsigned int height,
+                                    unsigned int win_length);
+
+    unsigned int get_width() const { return width_; }
+    unsigned int get_height() const { return height_; }
+    unsigned int get_win_length() const { return win_length_; }
+    unsigned int get_cell_count() const { return width_ * height_; }
+    unsigned int get_line_count() const { return line_masks_.size(); }
+
+    const Bitboard& get_line_mask(unsigned int line) const
+    {
+      return line_masks_[line];
+    }
+
+    Direction get_line_direction(unsigned int line) const
+    {
+      return line_directions_[line];
+    }
+
+    // Cells of a line, win_length of them starting at the given pointer
+    const unsigned short* get_line_cells(unsigned int line) const
+    {
+      return &line_cells_[line * win_length_];
+    }
+
+    // Lines that go through a cell, from first up to (not including) last
+    const unsigned short* get_cell_lines_begin(unsigned int cell) const
+    {
+      return &cell_lines_[cell_line_starts_[cell]];
+    }
+
+    const unsigned short* get_cell_lines_end(unsigned int cell) const
+    {
+      return &cell_lines_[0] + cell_line_starts_[cell + 1];
+    }
+
+    // Hash of the board size, the starting hash of an empty board
+    uint64_t get_hash_seed() const { return hash_seed_; }
+
+    // Number of rotations and reflections that map the board onto itself, 8
+    // for a square board and 4 otherwise. Symmetry 0 leaves every cell where
+    // it is.
+    unsigned int get_symmetry_count() const { return symmetry_count_; }
+
+    // Cell the given cell is moved to by a symmetry
+    unsigned int get_symmetry_cell(unsigned int symmetry,
+                                   unsigned int cell) const
+    {
+      return symmetry_cells_[symmetry * get_cell_count() + cell];
+    }
+
+    // Symmetry that undoes the given one, used to map a cell of a transformed
+    // board back to the original board
+    unsigned int get_inverse_symmetry(unsigned int symmetry) const
+    {
+      return inverse_symmetries_[symmetry];
+    }
+
+    // Zobrist key of a token after the board is transformed by a symmetry,
+    // the same as ZobristKey(get_symmetry_cell(symmetry, cell), player)
+    uint64_t get_symmetry_key(unsigned int symmetry, unsigned int cell,
+                              bool player) const
+    {
+      return symmetry_keys_[(symmetry * get_cell_count() + cell) * 2 +
+                            (player ? 0 : 1)];
+    }
+
+   private:
+    BoardGeometry(unsigned int width, unsigned int height,
+                  unsigned int win_length);
+
+    unsigned int width_;
+    unsigned int height_;
+    unsigned int win_length_;
+
+    std::vector<Bitboard> line_masks_;
+    std::vector<Direction> line_directions_;
+    std::vector<unsigned short> line_cells_;
+
+    std::vector<unsigned short> cell_line_starts_;
+    std::vector<unsigned short> cell_lines_;
+
+    uint64_t hash_seed_;
+
+    unsigned int symmetry_count_;
+    std::vector<unsigned short> symmetry_cells_;
+    unsigned int inverse_symmetries_[kMaxSymmetries];
+    std::vector<uint64_t> symmetry_keys_;
+  };
+
+  class TicTacToe;
+
+  // Read-only view of a board that can be indexed like the old char grid,
+  // view[x][y] gives 'X', 'O' or ' '
+  class BoardView
+  {
+   public:
+    class Column
+    {
+     public:
+      Column(const TicTacToe* board, unsigned int x) : board_(board), x_(x) {}
+
+      char operator[](unsigned int y) const;
+
+     private:
+      const TicTacToe* board_;
+      unsigned int x_;
+    };
+
+    explicit BoardView(const TicTacToe* board) : board_(board) {}
+
+    Column operator[](unsigned int x) const { return Column(board_, x); }
+
+   private:
+    const TicTacToe* board_;
+  };
+
+  // Random key for a token of the given player on the given cell, the hash
+  // of a board is the xor of the keys of all of its tokens
+  uint64_t ZobristKey(unsigned int cell, bool player);
+
+  class TicTacToe
+  {
+   public:
+    // Constructors
+    TicTacToe();
+    TicTacToe(unsigned int width, unsigned int height,
+              unsigned int win_length);
+    TicTacToe(const char* game_state);
+    TicTacToe(const char* game_state, unsigned int width, unsigned int height,
+              unsigned int win_length);
+    TicTacToe(const TicTacToe& board);
+
+    TicTacToe& operator=(const TicTacToe& board);
+
+    // Get game info
+    BoardView get_board_data() const { return BoardView(this); }
+    const Bitboard& get_x_bits() const { return x_bits_; }
+    const Bitboard& get_o_bits() const { return o_bits_; }
+    const BoardGeometry& get_geometry() const { return *geometry_; }
+    unsigned int get_width() const { return widht_; }
+    unsigned int get_height() const { return height_; }
+    unsigned int get_win_length() const { return win_length_; }
+    unsigned int get_empty_spaces() const { return empty_spaces_; }
+    uint64_t get_hash() const { return hashes_[0]; }
+
+    // Hash the board would have after being transformed by a symmetry
+    uint64_t get_symmetry_hash(unsigned int symmetry) const
+    {
+      return hashes_[symmetry];
+    }
+
+    // Hash that is the same for every rotation and reflection of the board
+    uint64_t get_canonical_hash() const
+    {
+      return hashes_[GetCanonicalSymmetry()];
+    }
+
+    // Sum over every line of the tokens in it when only one player has tokens
+    // in it, positive for 'X'. Kept up to date as tokens are placed.
+    int get_line_score() const { return line_score_; }
+
+    // Number of tokens each player has in a line
+    unsigned int get_line_count(unsigned int line, bool player) const
+    {
+      return line_counts_[line][player ? 0 : 1];
+    }
+
+    char GetCell(unsigned int x, unsigned int y) const
+    {
+      unsigned int cell = y * widht_ + x;
+
+      if (x_bits_.Test(cell))
+        return 'X';
+      if (o_bits_.Test(cell))
+        return 'O';
+      return ' ';
+    }
+
+    // Symmetries of the board
+    unsigned int GetCanonicalSymmetry() const;
+    bool IsSymmetric(unsigned int symmetry) const;
+    TicTacToe Transform(unsigned int symmetry) const;
+
+    void ClearBoard();
+
+    // Plays game between two players
+    void PlayGame();
+
+    bool PlaceToken(bool player, unsigned int x, unsigned int y);
+    bool RemoveToken(unsigned int x, unsigned int y);
+
+    // Check board states
+    std::pair<bool, char> CheckForWin() const;
+    std::pair<bool, char> IsGameOver() const;
+    bool IsBoardFull() const;
+
+    void PrintBoard() const;
+
+   private:
+    void CopyFrom(const TicTacToe& board);
+    void ToggleHashes(unsigned int cell, bool player);
+
+    // Size of board
+    unsigned int widht_ = 3;
+    unsigned int height_ = 3;
+
+    // Number of tokens in a row needed to win
+    unsigned int win_length_ = 3;
+
+    const BoardGeometry* geometry_;
+
+    unsigned int empty_spaces_;
+
+    // Cells held by each player
+    Bitboard x_bits_;
+    Bitboard o_bits_;
+
+    // Zobrist hash of the tokens on the board under each symmetry, kept up to
+    // date by PlaceToken. Only the first get_symmetry_count() are used.
+    uint64_t hashes_[kMaxSymmetries];
+
+    // Token of the first player to get win_length in a row, ' ' if nobody has
+    char winner_;
+
+    int line_score_;
+
+    // Number of lines each player has filled, used to find the winner again
+    // when a token is removed
+    unsigned short winning_lines_[2];
+
+    // Tokens of 'X' and 'O' in each line of the geometry, only the first
+    // get_line_count() lines are used
+    unsigned char line_counts_[kMaxLines][2];
+  };
+
+  // Compact binary form of a board, 3 bytes for its size and then 2 bits for
+  // each cell
+  std::vector<uint8_t> PackBoard(const TicTacToe &board);
+  bool UnpackBoard(const uint8_t* data, size_t size, TicTacToe* board);
+
+  inline char BoardView::Column::operator[](unsigned int y) const
+  {
+    return board_->GetCell(x_, y);
+  }
+}
+
+#endif  // TICTACTOE_H_
@@ -1,61 +1,322 @@
-#include <utility>
-
-#include "tictactoe.h"
-
-/******************************************************************************
- * 
- * File for managing the tic-tac-toe a.i.
- * 
- * Author: Thomas Andrasek
- * 
- * Last updated: 2020/10/05
- * 
- * ***************************************************************************/
-
-namespace tictactoeai
-{
-  class Node
-  {
-   public:
-    // Copy of game board
-    tictactoe::TicTacToe* board_data_ = NULL;
-
-    unsigned int child_arr_length_;
-    Node** children_ = NULL;
-
-    int game_score_;
-
-    // The last placement of the baord
-    std::pair<unsigned int, unsigned int> placement_;
-
-    int best_child_;
-
-    // Constructors
-    Node(tictactoe::TicTacToe *board, 
-         std::pair<unsigned int, unsigned int> placement);
-  };
-
-  int CalcGameScore(const tictactoe::TicTacToe &board);
-
-  // Check if certain areas are blocked
-  bool IsRowBlocked(const tictactoe::TicTacToe &board, 
-                    unsigned int x, unsigned int y);
-  bool IsColumnBlocked(const tictactoe::TicTacToe &board, 
-                       unsigned int x, unsigned int y);
-  bool IsRightDiagnolBlocked(const tictactoe::TicTacToe &board, 
-                             unsigned int x, unsigned int y);
-  bool IsLeftDiagnolBlocked(const tictactoe::TicTacToe &board, 
-                            unsigned int x, unsigned int y);
-
-  // Decide where the a.i. should put the next token
-  std::pair<unsigned int, unsigned int> MakePlacementChoice(
-      const tictactoe::TicTacToe &board, 
-      unsigned int move_depth, 
-      bool player);
-
-  // Minimax functions
-  void CalcMaxChild(Node* root, bool top_root, unsigned int move_depth,
-                    int alpha, int beta);
-  void CalcMinChild(Node* root, bool top_root, unsigned int move_depth,
-                    int alpha, int beta);
-}
\ No newline at end of file
+#ifndef TICTACTOE_AI_H_
+#define TICTACTOE_AI_H_
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <future>
+#include <utility>
+
+#include "mcts.h"
+#include "move_ordering.h"
+#include "search_arena.h"
+#include "search_stats.h"
+#include "tictactoe.h"
+#include "transposition_table.h"
+#include "work_stealing_pool.h"
+
+/******************************************************************************
+ * 
+ * File for managing the tic-tac-toe a.i.
+ * 
+ * Author: Thomas Andrasek
+ * 
+ * Last updated: 2026/10/18
+ * 
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  class OpeningBook;
+  class ProofTable;
+
+  class Node
+  {
+   public:
+    // Copy of game board
+    tictactoe::TicTacToe* board_data_ = NULL;
+
+    unsigned int child_arr_length_;
+    Node** children_ = NULL;
+
+    int game_score_;
+
+    // The last placement of the baord
+    std::pair<unsigned int, unsigned int> placement_;
+
+    int best_child_;
+
+    // Constructors
+    Node(tictactoe::TicTacToe *board, 
+         std::pair<unsigned int, unsigned int> placement);
+  };
+
+  // Boards with more cells than this are searched by kEngineAuto with Monte
+  // Carlo tree search
+  const unsigned int kMctsAutoCells = 64;
+
+  // Which search MakePlacementChoice and MakeTimedPlacementChoice use
+  enum SearchEngine
+  {
+    // Alpha beta search, exact up to the depth it looks ahead
+    kEngineMinimax,
+
+    // Monte Carlo tree search with random playouts, ignores the move depth
+    kEngineMcts,
+
+    // Monte Carlo tree search on boards of more than kMctsAutoCells cells,
+    // alpha beta search on smaller boards
+    kEngineAuto,
+
+    // Proof number search, which proves whether the game is won, lost or
+    // tied and plays a move that keeps it that way. Ignores the move depth,
+    // and falls back to alpha beta search when it runs out of nodes or time.
+    kEngineProof
+  };
+
+  // Time budget of a search that runs until it is cancelled, see
+  // SearchOptions::cancel_
+  const std::chrono::milliseconds kNoTimeLimit =
+   std::chrono::milliseconds::max();
+
+  // Settings for a call to MakePlacementChoice
+  class SearchOptions
+  {
+   public:
+    // Transposition table to reuse between calls, may be NULL
+    TranspositionTable* table_ = NULL;
+
+    // Number of threads to search with, the calling thread counts as one.
+    // Ignored when a pool is given.
+    unsigned int threads_ = 1;
+
+    // Pool to search with instead of starting threads for each call
+    WorkStealingPool* pool_ = NULL;
+
+    // The root is always split between the threads, deeper nodes are split
+    // too when they still have at least this many moves to look ahead. 0 only
+    // splits the root.
+    unsigned int split_depth_ = 0;
+
+    // Treat rotations and reflections of a board as the same position, so
+    // they share table entries and only one of the moves a symmetric board
+    // maps onto each other is searched
+    bool symmetry_ = true;
+
+    // Answer full depth and timed choices on a standard 3x3 board from the
+    // solved PerfectPlayTable instead of searching
+    bool perfect_play_ = true;
+
+    // Filled in with what the search did when the program is compiled with
+    // TICTACTOEAI_SEARCH_STATS, may be NULL. The counters are added to, so
+    // one set of stats can cover several searches.
+    SearchStats* stats_ = NULL;
+
+    // MoveOrderingFlags for the order moves are searched in. The move chosen
+    // does not depend on them, only how fast it is found.
+    unsigned int move_ordering_ = kOrderAll;
+
+    SearchEngine engine_ = kEngineMinimax;
+
+    // Playouts a Monte Carlo tree search runs, 0 for no limit when it has a
+    // time budget
+    unsigned int mcts_iterations_ = 10000;
+
+    // How much the Monte Carlo tree search favors moves with few playouts
+    // over the moves that have done best so far
+    double mcts_exploration_ = 1.4;
+
+    // Seed of the random playouts, a search on one thread with the same seed
+    // always chooses the same move
+    uint64_t mcts_seed_ = 1;
+
+    // Node pool to reuse between Monte Carlo tree searches, may be NULL
+    MctsNodePool* mcts_pool_ = NULL;
+
+    // Search on from the tree already in mcts_pool_ instead of clearing it.
+    // The first node of the pool must then be the board being searched, see
+    // GameSession which keeps it that way between moves.
+    bool mcts_keep_tree_ = false;
+
+    // Set to true from another thread to stop the search early, it then
+    // returns the deepest search it finished. May be NULL.
+    const std::atomic<bool>* cancel_ = NULL;
+
+    // Book of positions searched ahead of time, a board found in it is
+    // answered without searching, may be NULL. A fixed depth choice only
+    // uses an entry searched at least as deep, and a timed choice only one
+    // searched to the end of the game.
+    const OpeningBook* book_ = NULL;
+
+    // Table to reuse between proof number searches, may be NULL. Without one
+    // each search makes a table of proof_table_megabytes_.
+    ProofTable* proof_table_ = NULL;
+    size_t proof_table_megabytes_ = 64;
+
+    // Most boards a proof number search looks at, 0 for no limit
+    uint64_t proof_max_nodes_ = 0;
+  };
+
+  // What a search found
+  class SearchResult
+  {
+   public:
+    // The chosen placement, {100, 100} when there was nothing to place
+    std::pair<unsigned int, unsigned int> placement_ = {100, 100};
+
+    // Score of the placement, positive when 'X' is winning
+    int score_ = 0;
+
+    // Depth of the deepest finished search
+    unsigned int depth_ = 0;
+
+    // Number of nodes visited, including any unfinished search
+    uint64_t nodes_ = 0;
+  };
+
+  // State of a search shared between all of its threads
+  class SearchProgress
+  {
+   public:
+    std::chrono::steady_clock::time_point deadline_;
+    bool has_deadline_ = false;
+
+    // Stops the search once it is set, may be NULL
+    const std::atomic<bool>* cancel_ = NULL;
+
+    // Set once the deadline has passed or the search was cancelled, every
+    // thread stops when it sees it
+    std::atomic<bool> stopped_{false};
+
+    // Nodes visited by threads other than the calling thread
+    std::atomic<uint64_t> nodes_{0};
+  };
+
+  class SplitPoint;
+
+  // State shared by every node of a single search
+  class SearchContext
+  {
+   public:
+    TranspositionTable* table_ = NULL;
+
+    WorkStealingPool* pool_ = NULL;
+    unsigned int split_depth_ = 0;
+    bool symmetry_ = true;
+
+    // Closest split point above the node, NULL when there is none
+    SplitPoint* split_ = NULL;
+
+    SearchProgress* progress_ = NULL;
+
+    // Nodes visited by this thread
+    uint64_t nodes_ = 0;
+
+    // Cell to try first at the top root, -1 for none
+    int root_first_move_ = -1;
+
+    // Depth the top root was searched to, the ply of a board is how far its
+    // move_depth is below this
+    unsigned int root_depth_ = 0;
+
+    // Stats of the thread running the node, NULL when they are not wanted
+    SearchStats* stats_ = NULL;
+
+    // Move ordering of the thread running the node
+    MoveOrderer* orderer_ = NULL;
+  };
+
+  int CalcGameScore(const tictactoe::TicTacToe &board);
+  int EvaluateBoard(const tictactoe::TicTacToe &board);
+  int CalcWinScore(const tictactoe::TicTacToe &board);
+
+  // Check if certain areas are blocked
+  bool IsRowBlocked(const tictactoe::TicTacToe &board, 
+                    unsigned int x, unsigned int y);
+  bool IsColumnBlocked(const tictactoe::TicTacToe &board, 
+                       unsigned int x, unsigned int y);
+  bool IsRightDiagnolBlocked(const tictactoe::TicTacToe &board, 
+                             unsigned int x, unsigned int y);
+  bool IsLeftDiagnolBlocked(const tictactoe::TicTacToe &board, 
+                            unsigned int x, unsigned int y);
+
+  // Decide where the a.i. should put the next token
+  std::pair<unsigned int, unsigned int> MakePlacementChoice(
+      const tictactoe::TicTacToe &board, 
+      unsigned int move_depth, 
+      bool player,
+      TranspositionTable* table = NULL);
+  std::pair<unsigned int, unsigned int> MakePlacementChoice(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options);
+  SearchResult ChoosePlacement(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options);
+  SearchResult AnalyzePlacement(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options);
+
+  // Decide where to put the next token within a time limit
+  SearchResult MakeTimedPlacementChoice(
+      const tictactoe::TicTacToe &board,
+      std::chrono::milliseconds time_budget,
+      bool player,
+      const SearchOptions &options);
+
+  // Decide on another thread, the search can be stopped early with
+  // SearchOptions::cancel_
+  std::future<SearchResult> StartPlacementChoice(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options);
+  std::future<SearchResult> StartTimedPlacementChoice(
+      const tictactoe::TicTacToe &board,
+      std::chrono::milliseconds time_budget,
+      bool player,
+      const SearchOptions &options);
+
+  // Decide where to put the next token with Monte Carlo tree search
+  SearchEngine ChooseEngine(
+      const tictactoe::TicTacToe &board,
+      const SearchOptions &options);
+  SearchResult MakeMctsPlacementChoice(
+      const tictactoe::TicTacToe &board,
+      bool player,
+      const SearchOptions &options,
+      std::chrono::milliseconds time_budget = std::chrono::milliseconds(0));
+
+  // Decide where to put the next token with proof number search
+  SearchResult MakeProofPlacementChoice(
+      const tictactoe::TicTacToe &board,
+      bool player,
+      const SearchOptions &options,
+      std::chrono::milliseconds time_budget = std::chrono::milliseconds(0));
+
+  // Build the tree of nodes for callers that want more than the choice
+  Node* AnalyzeMoves(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options,
+      SearchArena* arena);
+  Node* BuildPrincipalVariation(
+      const tictactoe::TicTacToe &board,
+      unsigned int move_depth,
+      bool player,
+      const SearchOptions &options,
+      SearchArena* arena);
+
+  // Negamax search, scores are from the view of the player to move
+  int Negamax(tictactoe::TicTacToe &board, bool player,
+              unsigned int move_depth, int alpha, int beta,
+              SearchContext* context, int* best_move = NULL);
+}
+
+#endif  // TICTACTOE_AI_H_
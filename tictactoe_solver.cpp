@@ -1,418 +1,1523 @@
-#include <utility>
-#include <iostream>
-
-#include "tictactoe_ai.h"
-
-/******************************************************************************
- * 
- * File for managing all the methods for the TicTacToe class
- * 
- * Author: Thomas Andrasek
- * 
- * Last updated: 2020/10/05
- * 
- * ***************************************************************************/
-
-//  Construct a Node object for the game decision tree
-//  
-//  @param board the tic-tac-toe board to copy and make moves on
-//  @param placement the position of the last token placed
-tictactoeai::Node::Node(tictactoe::TicTacToe *board,
-           std::pair<unsigned int, unsigned int> placement)
-{
-  this->board_data_ = board;
-  this->placement_ = placement;
-  this->child_arr_length_ = 0;
-  // Using -1 to indicate the best move position hasn't been chosen yet
-  this->best_child_ = -1;
-  // Temp game score, using -1337 as a key value
-  this->game_score_ = -1337;
-}
-
-// Calculates the game score of the given board
-// 
-// A positive score indicates that 'X' is winning, and a negative score
-// indicates that 'O' is winning. If the score is 0 the current game state is a
-// tie. 
-// 
-// Points are awarded for having control of a given dirrection without being
-// blocked by the other player. Points are also awarded for winning the game.
-//
-// @param board the board to calculate the game score of
-// 
-// @return the score of the game
-int tictactoeai::CalcGameScore(const tictactoe::TicTacToe &board)
-{
-  // Scores for each player
-  int x = 0;
-  int o = 0;
-
-  for (unsigned int i = 0; i < board.get_width(); ++i)
-  {
-    for (unsigned int j = 0; j < board.get_height(); ++j)
-    {
-      char piece = board.get_board_data()[i][j];
-
-      if (piece != ' ')
-      {
-        // Check if the four dirrections are blocked in any case
-
-        if (!IsRowBlocked(board, i, j))
-        {
-          if (piece == 'X')
-            x += 1;
-          else
-            o += 1;
-        }
-
-        if (!IsColumnBlocked(board, i, j))
-        {
-          if (piece == 'X')
-            x += 1;
-          else
-            o += 1;
-        }
-
-        if (!IsRightDiagnolBlocked(board, i, j))
-        {
-          if (piece == 'X')
-            x += 1;
-          else
-            o += 1;
-        }
-
-        if (!IsLeftDiagnolBlocked(board, i, j))
-        {
-          if (piece == 'X')
-            x += 1;
-          else
-            o += 1;
-        }
-      }
-    }
-  }
-
-  // Award 100 points if there is a winner
-  std::pair<bool, char> win_data = board.CheckForWin();
-  if (win_data.second == 'X')
-    x+=100;
-  else if (win_data.second == 'O')
-    o+=100;
-
-  return x-o;
-}
-
-// Checks if the row is blocked at the given position
-//
-// @param board the tictactoe board
-// @param x the column position
-// @param y the row position
-//
-// @return whether or not the row is blocked
-bool tictactoeai::IsRowBlocked(const tictactoe::TicTacToe &board,
-                               unsigned int x, unsigned int y)
-{
-  char piece = board.get_board_data()[x][y];
-
-  if ((board.get_board_data()[0][y] == ' ' ||
-       board.get_board_data()[0][y] == piece) &&
-      (board.get_board_data()[1][y] == ' ' ||
-       board.get_board_data()[1][y] == piece) &&
-      (board.get_board_data()[2][y] == ' ' ||
-       board.get_board_data()[2][y] == piece))
-    return false;
-
-  return true;
-}
-
-// Checks if the column is blocked at the given position
-//
-// @param board the tictactoe board
-// @param x the column position
-// @param y the row position
-//
-// @return whether or not the column is blocked
-bool tictactoeai::IsColumnBlocked(const tictactoe::TicTacToe &board,
-                                  unsigned int x, unsigned int y)
-{
-  char piece = board.get_board_data()[x][y];
-
-  if ((board.get_board_data()[x][0] == ' ' ||
-       board.get_board_data()[x][0] == piece) && 
-      (board.get_board_data()[x][1] == ' ' ||
-       board.get_board_data()[x][1] == piece) &&
-      (board.get_board_data()[x][2] == ' ' || 
-       board.get_board_data()[x][2] == piece))
-    return false;
-
-  return true;
-}
-
-// Checks if the right diagnol on the board is blocked
-//
-// @param board the tictactoe board
-// @param x the column position
-// @param y the row position
-//
-// @return whether the right diagnol on the board is blocked
-bool tictactoeai::IsRightDiagnolBlocked(const tictactoe::TicTacToe &board,
-                                        unsigned int x, unsigned int y)
-{
-  char piece = board.get_board_data()[x][y];
-
-  // check if the given position is on the right angle
-  if ((x == 0 && y == 0) || (x==1 && y==1) || (x==2 && y==2))
-  {
-    if ((board.get_board_data()[0][0] == ' ' ||
-         board.get_board_data()[0][0] == piece) &&
-        (board.get_board_data()[1][1] == ' ' ||
-         board.get_board_data()[1][1] == piece) &&
-        (board.get_board_data()[2][2] == ' ' ||
-         board.get_board_data()[2][2] == piece))
-      return false;
-  }
-
-  return true;
-}
-
-// Checks if the left diagnol on the board is blocked
-//
-// @param board the tictactoe board
-// @param x the column position
-// @param y the row position
-//
-// @return whether the left diagnol on the board is blocked
-bool tictactoeai::IsLeftDiagnolBlocked(const tictactoe::TicTacToe &board,
-                                       unsigned int x, unsigned int y)
-{
-  char piece = board.get_board_data()[x][y];
-
-  // check if the given position is on the left angle
-  if ((x == 0 && y == 2) || (x==1 && y==1) || (x==2 && y==0))
-  {
-    if ((board.get_board_data()[0][2] == ' ' ||
-         board.get_board_data()[0][2] == piece) &&
-        (board.get_board_data()[1][1] == ' ' ||
-         board.get_board_data()[1][1] == piece) &&
-        (board.get_board_data()[2][0] == ' ' ||
-         board.get_board_data()[2][0] == piece))
-      return false;
-  }
-
-  return true;
-}
-
-// This function makes a choice for placing a token on the board using the idea
-// of the minimax algorithm. It generates moves up the specified move depth or
-// until the game has been completed. After generating moves the minimax
-// algorithm will make a choice on where is the best place to place a token
-// 
-// If a game score is positive that means that 'X' is winning, if the game
-// score is negative then 'O' is winning, and if the score is zero then it is
-// currently a tie.
-//
-// Alpha beta pruning is also implemented to increase the speed of the function
-// To learn more about minimax and alpha beta pruning check out the wikipedia
-// article
-// - https://en.wikipedia.org/wiki/Minimax
-// - https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
-// 
-// @param board current tic-tac-toe board
-// @param move_depth the amount of moves to look ahead
-// @param player which players turn it is, true for 'X' false for 'O'
-std::pair<unsigned int, unsigned int> tictactoeai::MakePlacementChoice(
-    const tictactoe::TicTacToe &board,
-    unsigned int move_depth,
-    bool player)
-{
-  tictactoe::TicTacToe *game = new tictactoe::TicTacToe(board);
-  Node* root = new Node(game, {100,100});
-
-  if (player)
-    CalcMaxChild(root, true, move_depth, INT32_MIN, INT32_MAX);
-  else
-    CalcMinChild(root, true, move_depth, INT32_MIN, INT32_MAX);
-
-  std::pair<unsigned int, unsigned int> placement =
-   root->children_[root->best_child_]->placement_;
-
-  if (root->children_)
-    {
-      for (unsigned int i = 0; i < root->child_arr_length_; ++i)
-      {
-        delete root->children_[i];
-      }
-
-      delete [] root->children_;
-    }
-
-  delete root;
-
-  return placement;
-}
-
-// Figures out which child node will result in the maximum game score
-// 
-// Implements alpha beta pruning in order to optimize the function
-//
-// @param root the root node to calculate the maximum child of
-// @param top_root whether or not the current root node is the root of the entire tree
-// @param move_depth how many moves to look ahead
-// @param alpha the alpha score for alpha beta pruning
-// @param beta the beta score for the alpha beta pruning
-void tictactoeai::CalcMaxChild(Node* root, bool top_root,
-                               unsigned int move_depth, int alpha, int beta)
-{
-  if (root)
-  {
-    // Checks if no more moves can be made
-    if (move_depth == 0 || root->board_data_->IsGameOver().first)
-    {
-      root->game_score_ = CalcGameScore(*root->board_data_);
-    }
-    else if (move_depth >= 1)
-    {
-      root->child_arr_length_ = (*root->board_data_).get_empty_spaces();
-      root->children_ = new Node*[root->child_arr_length_];
-      for (unsigned int i = 0; i < root->child_arr_length_; ++i)
-      {
-        root->children_[i] = NULL;
-      }
-
-      unsigned int child = 0;
-      int max = 0;
-
-      for (unsigned int i = 0; i < (*root->board_data_).get_width(); ++i)
-      {
-        for (unsigned int j = 0; j < (*root->board_data_).get_height(); ++j)
-        {
-          if (root->board_data_->get_board_data()[i][j] == ' ')
-          {
-            tictactoe::TicTacToe *copy = new tictactoe::TicTacToe(*root->board_data_);
-            copy->PlaceToken(true, i, j);
-            root->children_[child] = new Node(copy, {i, j});
-            CalcMinChild(root->children_[child], false, move_depth-1, alpha,
-                         beta);
-
-            if (root->children_[max]->game_score_ <
-                root->children_[child]->game_score_)
-              max = child;
-
-            if (root->children_[max]->game_score_ > alpha)
-              alpha = root->children_[max]->game_score_;
-
-            child++;
-
-            if (beta <= alpha)
-              break;
-          }
-        }
-
-        if (beta <= alpha)
-          break;
-      }
-
-      root->game_score_ = root->children_[max]->game_score_;
-
-      if (top_root)
-        root->best_child_ = max;
-    }
-
-    if (root->board_data_)
-        delete root->board_data_;
-
-      if (root->children_ && !top_root)
-      {
-        for (unsigned char i = 0; i < root->child_arr_length_; ++i)
-        {
-          if (root->children_[i])
-            delete root->children_[i];
-        }
-
-        delete [] root->children_;
-      }
-  }
-}
-
-// Figures out which child node will result in the minimum game score
-// 
-// Implements alpha beta pruning in order to optimize the function
-//
-// @param root the root node to calculate the minimum child of
-// @param top_root whether or not the current root node is the root of the entire tree
-// @param move_depth how many moves to look ahead
-// @param alpha the alpha score for alpha beta pruning
-// @param beta the beta score for the alpha beta pruning
-void tictactoeai::CalcMinChild(Node* root, bool top_root,
-                               unsigned int move_depth, int alpha, int beta)
-{
-  if (root)
-  {
-    // Checks if no more moves can be made
-    if (move_depth == 0 || root->board_data_->IsGameOver().first)
-    {
-      root->game_score_ = CalcGameScore(*root->board_data_);
-    }
-    else if (move_depth >= 1)
-    {
-      root->child_arr_length_ = (*root->board_data_).get_empty_spaces();
-      root->children_ = new Node*[root->child_arr_length_];
-      for (unsigned int i = 0; i < root->child_arr_length_; ++i)
-      {
-        root->children_[i] = NULL;
-      }
-
-      unsigned int child = 0;
-      int min = 0;
-
-      for (unsigned int i = 0; i < (*root->board_data_).get_width(); ++i)
-      {
-        for (unsigned int j = 0; j < (*root->board_data_).get_height(); ++j)
-        {
-          if (root->board_data_->get_board_data()[i][j] == ' ')
-          {
-            tictactoe::TicTacToe *copy = new tictactoe::TicTacToe(*root->board_data_);
-            copy->PlaceToken(true, i, j);
-            root->children_[child] = new Node(copy, {i, j});
-            CalcMaxChild(root->children_[child], false, move_depth-1, alpha,
-                         beta);
-
-            if (root->children_[min]->game_score_ >
-                root->children_[child]->game_score_)
-              min = child;
-
-            if (root->children_[min]->game_score_ < beta)
-              beta = root->children_[min]->game_score_;
-
-            child++;
-
-            if (beta <= alpha)
-              break;
-          }
-        }
-
-        if (beta <= alpha)
-          break;
-      }
-
-      root->game_score_ = root->children_[min]->game_score_;
-
-      if (top_root)
-        root->best_child_ = min;
-    }
-
-    if (root->board_data_)
-        delete root->board_data_;
-
-      if (root->children_ && !top_root)
-      {
-        for (unsigned char i = 0; i < root->child_arr_length_; ++i)
-        {
-          if (root->children_[i])
-            delete root->children_[i];
-        }
-
-        delete [] root->children_;
-      }
-  }
-}
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <utility>
+
+#include "opening_book.h"
+#include "perfect_play_table.h"
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ * 
+ * File for managing all the methods for the TicTacToe class
+ * 
+ * Author: Thomas Andrasek
+ * 
+ * Last updated: 2026/10/18
+ * 
+ * ***************************************************************************/
+
+
+namespace tictactoeai
+{
+  // A node whose younger children are searched in parallel once its eldest
+  // child has been searched. The best score so far is shared so children that
+  // start later get a narrower window.
+  class SplitPoint
+  {
+   public:
+    // Split point this one was made under, NULL for the first
+    SplitPoint* parent_ = NULL;
+
+    // Set once a child scores outside of the window, the other children are
+    // not needed any more
+    std::atomic<bool> cutoff_{false};
+
+    std::mutex mutex_;
+    int best_score_ = 0;
+    int best_child_ = 0;
+
+    // Where the best child came before the moves were ordered, ties go to
+    // the child that came first
+    unsigned int best_rank_ = 0;
+
+    // Whether this split point or any split point above it was cut off
+    bool IsCutoff() const
+    {
+      for (const SplitPoint* split = this; split; split = split->parent_)
+        if (split->cutoff_.load(std::memory_order_relaxed))
+          return true;
+
+      return false;
+    }
+  };
+}
+
+namespace
+{
+  // Bounds of every score, scores are negated between the players so the
+  // bounds are kept symmetric
+  const int kInfinity = INT32_MAX;
+
+  // Half the width of the first window searched around the expected score,
+  // the window grows by this factor each time the score falls outside of it
+  const int kAspirationWindow = 16;
+  const int kAspirationGrowth = 4;
+
+  // Whether the result of the search is no longer needed, either because the
+  // search ran out of time or because a split point above it was cut off
+  bool IsAborted(const tictactoeai::SearchContext* context)
+  {
+    if (context->progress_ &&
+        context->progress_->stopped_.load(std::memory_order_relaxed))
+      return true;
+
+    return context->split_ && context->split_->IsCutoff();
+  }
+
+  // Counts a visited node, checking the clock and whether the search was
+  // cancelled every 1024 nodes and stopping the search when it should
+  //
+  // @param context the search state of the thread visiting the node
+  void CountNode(tictactoeai::SearchContext* context)
+  {
+    ++context->nodes_;
+
+    if ((context->nodes_ & 1023) != 0 || !context->progress_)
+      return;
+
+    tictactoeai::SearchProgress* progress = context->progress_;
+    if ((progress->has_deadline_ &&
+         std::chrono::steady_clock::now() >= progress->deadline_) ||
+        (progress->cancel_ &&
+         progress->cancel_->load(std::memory_order_relaxed)))
+      progress->stopped_ = true;
+  }
+
+  // The Record functions fill in the stats of the search, they do nothing
+  // unless the program is compiled with TICTACTOEAI_SEARCH_STATS
+
+  // Counts a visited board
+  //
+  // @param context the search state of the thread visiting the board
+  // @param move_depth how many moves are left to look ahead
+  void RecordNode(const tictactoeai::SearchContext* context,
+                  unsigned int move_depth)
+  {
+#ifdef TICTACTOEAI_SEARCH_STATS
+    if (!context->stats_)
+      return;
+
+    ++context->stats_->nodes_;
+    context->stats_->max_ply_ = std::max(context->stats_->max_ply_,
+                                         context->root_depth_ - move_depth);
+#else
+    (void)context;
+    (void)move_depth;
+#endif
+  }
+
+  // Counts a board whose moves are about to be searched
+  void RecordExpanded(const tictactoeai::SearchContext* context)
+  {
+#ifdef TICTACTOEAI_SEARCH_STATS
+    if (context->stats_)
+      ++context->stats_->expanded_;
+#else
+    (void)context;
+#endif
+  }
+
+  // Counts a board scored by EvaluateBoard
+  void RecordLeaf(const tictactoeai::SearchContext* context)
+  {
+#ifdef TICTACTOEAI_SEARCH_STATS
+    if (context->stats_)
+      ++context->stats_->leaves_;
+#else
+    (void)context;
+#endif
+  }
+
+  // Counts a board whose remaining moves were pruned
+  //
+  // @param context the search state
+  // @param move_depth how many moves the board had left to look ahead
+  // @param child the index of the move that caused the cutoff
+  void RecordCutoff(const tictactoeai::SearchContext* context,
+                    unsigned int move_depth, unsigned int child)
+  {
+#ifdef TICTACTOEAI_SEARCH_STATS
+    if (!context->stats_)
+      return;
+
+    tictactoeai::SearchStats* stats = context->stats_;
+    unsigned int ply = context->root_depth_ - move_depth;
+
+    ++stats->cutoffs_;
+    ++stats->cutoffs_by_ply_[std::min(ply, stats->kMaxPly - 1)];
+    ++stats->cutoffs_by_move_[std::min(child, stats->kMaxMoveIndex - 1)];
+#else
+    (void)context;
+    (void)move_depth;
+    (void)child;
+#endif
+  }
+
+  // Counts a transposition table lookup
+  //
+  // @param context the search state
+  // @param hit whether the stored score was used
+  void RecordProbe(const tictactoeai::SearchContext* context, bool hit)
+  {
+#ifdef TICTACTOEAI_SEARCH_STATS
+    if (!context->stats_)
+      return;
+
+    ++context->stats_->table_probes_;
+    if (hit)
+      ++context->stats_->table_hits_;
+#else
+    (void)context;
+    (void)hit;
+#endif
+  }
+
+  // Lists the empty cells of the board in the order they are searched, down
+  // each column in turn like the board has always been scanned, with
+  // first_move moved to the front when it is empty
+  //
+  // When symmetry is on and a rotation or reflection maps the board onto
+  // itself, a move that the rotation or reflection maps onto a move already
+  // listed leads to the same game and is left out.
+  //
+  // @param board the board to list the moves of
+  // @param first_move the cell to try first, -1 for none
+  // @param symmetry whether to leave out symmetric moves
+  // @param moves set to the cells, must have room for every cell
+  //
+  // @return the number of moves
+  unsigned int GenerateMoves(const tictactoe::TicTacToe &board, int first_move,
+                             bool symmetry, unsigned short* moves)
+  {
+    const tictactoe::BoardGeometry& geometry = board.get_geometry();
+    unsigned int width = board.get_width();
+
+    // Symmetries of the board, past the identity
+    unsigned int symmetries[tictactoe::kMaxSymmetries];
+    unsigned int symmetry_count = 0;
+
+    if (symmetry)
+      for (unsigned int i = 1; i < geometry.get_symmetry_count(); ++i)
+        if (board.IsSymmetric(i))
+          symmetries[symmetry_count++] = i;
+
+    unsigned int count = 0;
+    tictactoe::Bitboard listed;
+
+    for (int k = -1; k < int(geometry.get_cell_count()); ++k)
+    {
+      int cell;
+      if (k < 0)
+        cell = first_move;
+      else
+      {
+        // Down each column in turn
+        cell = (k % board.get_height()) * width + k / board.get_height();
+        if (cell == first_move)
+          continue;
+      }
+
+      if (cell < 0 || board.GetCell(cell % width, cell / width) != ' ')
+        continue;
+
+      bool repeated = false;
+      for (unsigned int i = 0; !repeated && i < symmetry_count; ++i)
+        repeated = listed.Test(geometry.get_symmetry_cell(symmetries[i], cell));
+
+      if (repeated)
+        continue;
+
+      listed.Set(cell);
+      moves[count++] = cell;
+    }
+
+    return count;
+  }
+
+  // Remaining depth a position is cached under. Any search at least as deep as
+  // the number of empty spaces plays every game out to the end, so all of
+  // those searches give the same score and can share an entry.
+  unsigned int TableDepth(const tictactoe::TicTacToe &board,
+                          unsigned int move_depth)
+  {
+    return std::min(move_depth, board.get_empty_spaces());
+  }
+
+  // Table key of a board. With symmetry on every rotation and reflection of
+  // the board gets the key of its canonical form so they share one entry.
+  //
+  // @param board the board to get the key of
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param symmetry whether to key the board by its canonical form
+  //
+  // @return the key to probe and store with
+  uint64_t TableKey(const tictactoe::TicTacToe &board, bool player,
+                    bool symmetry)
+  {
+    return tictactoeai::TranspositionTable::MakeKey(
+        symmetry ? board.get_canonical_hash() : board.get_hash(), player);
+  }
+
+  // Looks the board up in the transposition table
+  //
+  // The leaf scores depend on how far the search looked ahead, so only entries
+  // searched to the same depth are used. A bound is only used when it already
+  // falls outside of the alpha beta window. The table keeps scores from the
+  // view of 'X' and the window and score here are from the view of the
+  // player to move.
+  //
+  // @param context the search state, its table may be NULL
+  // @param board the board to look up
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param move_depth how many moves are left to look ahead
+  // @param alpha the alpha score for alpha beta pruning
+  // @param beta the beta score for alpha beta pruning
+  // @param score set to the stored score when it can be used
+  // @param hash_move set to the cell of the stored best move when there is an
+  //  entry for the board, even one that can not be used
+  //
+  // @return whether the stored score can be used instead of searching
+  bool ProbeTable(const tictactoeai::SearchContext* context,
+                  const tictactoe::TicTacToe &board, bool player,
+                  unsigned int move_depth, int alpha, int beta, int* score,
+                  int* hash_move)
+  {
+    if (!context->table_)
+      return false;
+
+    tictactoeai::TableEntry entry;
+    uint64_t key = TableKey(board, player, context->symmetry_);
+
+    bool found = context->table_->Probe(key, &entry);
+    if (found && entry.best_move_ != tictactoeai::kNoMove)
+    {
+      const tictactoe::BoardGeometry& geometry = board.get_geometry();
+      *hash_move = entry.best_move_;
+
+      // The move was stored on the canonical form of the board
+      if (context->symmetry_)
+        *hash_move = geometry.get_symmetry_cell(
+            geometry.get_inverse_symmetry(board.GetCanonicalSymmetry()),
+            entry.best_move_);
+    }
+
+    int x_alpha = player ? alpha : -beta;
+    int x_beta = player ? beta : -alpha;
+
+    bool hit = found && entry.depth_ == TableDepth(board, move_depth) &&
+               (entry.bound_ == tictactoeai::kExactBound ||
+                (entry.bound_ == tictactoeai::kLowerBound &&
+                 entry.score_ >= x_beta) ||
+                (entry.bound_ == tictactoeai::kUpperBound &&
+                 entry.score_ <= x_alpha));
+    RecordProbe(context, hit);
+
+    if (hit)
+      *score = player ? entry.score_ : -entry.score_;
+
+    return hit;
+  }
+
+  // Saves the result of searching a board in the transposition table
+  //
+  // With symmetry on the best move is stored as the cell it lands on in the
+  // canonical form of the board, get_inverse_symmetry of the canonical
+  // symmetry maps it back onto any board with the same entry.
+  //
+  // @param context the search state, its table may be NULL
+  // @param board the searched board
+  // @param player which players turn it was, true for 'X' false for 'O'
+  // @param move_depth how many moves were left to look ahead
+  // @param alpha the alpha score the board was searched with
+  // @param beta the beta score the board was searched with
+  // @param score the score the search found, the window and score are from
+  //  the view of the player to move
+  // @param best_move the cell of the best move
+  void StoreInTable(const tictactoeai::SearchContext* context,
+                    const tictactoe::TicTacToe &board, bool player,
+                    unsigned int move_depth, int alpha, int beta, int score,
+                    unsigned short best_move)
+  {
+    if (!context->table_)
+      return;
+
+    if (context->symmetry_)
+      best_move = board.get_geometry().get_symmetry_cell(
+          board.GetCanonicalSymmetry(), best_move);
+
+    tictactoeai::BoundType bound = tictactoeai::kExactBound;
+    if (score <= alpha)
+      bound = player ? tictactoeai::kUpperBound : tictactoeai::kLowerBound;
+    else if (score >= beta)
+      bound = player ? tictactoeai::kLowerBound : tictactoeai::kUpperBound;
+
+    context->table_->Store(TableKey(board, player, context->symmetry_),
+                           player ? score : -score,
+                           TableDepth(board, move_depth), bound, best_move);
+  }
+
+  // Searches the board after a move with principal variation search. Every
+  // move but the first is expected to be worse than the best move so far, so
+  // it is first searched with a null window that only tells whether it is,
+  // and searched again with the full window when it turns out better.
+  //
+  // @param board the board after the move
+  // @param player the player who made the move, true for 'X' false for 'O'
+  // @param move_depth how many moves are left to look ahead after the move
+  // @param alpha the alpha score of the player who made the move
+  // @param beta the beta score of the player who made the move
+  // @param null_window whether to try a null window first
+  // @param context the search state
+  //
+  // @return the score of the move from the view of the player who made it
+  int SearchMove(tictactoe::TicTacToe &board, bool player,
+                 unsigned int move_depth, int alpha, int beta,
+                 bool null_window, tictactoeai::SearchContext* context)
+  {
+    if (null_window && alpha + 1 < beta)
+    {
+      int score = -tictactoeai::Negamax(board, !player, move_depth,
+                                        -alpha - 1, -alpha, context);
+
+      if (score <= alpha || score >= beta || IsAborted(context))
+        return score;
+    }
+
+    return -tictactoeai::Negamax(board, !player, move_depth, -beta, -alpha,
+                                 context);
+  }
+
+  // Sorts the moves of a board with the move ordering of the thread
+  //
+  // @param context the search state of the thread
+  // @param board the board the moves are for
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param move_depth how many moves the board has left to look ahead
+  // @param hash_move the cell to try first, -1 for none
+  // @param moves the moves to sort
+  // @param count the number of moves
+  // @param ranks set to where each move was before sorting when not NULL
+  void OrderMoves(const tictactoeai::SearchContext* context,
+                  const tictactoe::TicTacToe &board, bool player,
+                  unsigned int move_depth, int hash_move,
+                  unsigned short* moves, unsigned int count,
+                  unsigned short* ranks)
+  {
+    unsigned short rank_of[tictactoe::kMaxCells];
+    if (ranks)
+      for (unsigned int i = 0; i < count; ++i)
+        rank_of[moves[i]] = i;
+
+    if (context->orderer_)
+      context->orderer_->Order(board, player,
+                               context->root_depth_ - move_depth, hash_move,
+                               moves, count);
+
+    if (ranks)
+      for (unsigned int i = 0; i < count; ++i)
+        ranks[i] = rank_of[moves[i]];
+  }
+
+  // Learns from a move that caused a cutoff
+  void UpdateOrdering(const tictactoeai::SearchContext* context, bool player,
+                      unsigned int move_depth, unsigned int cell)
+  {
+    if (context->orderer_)
+      context->orderer_->UpdateOnCutoff(player,
+                                        context->root_depth_ - move_depth,
+                                        cell, move_depth);
+  }
+
+  // Whether the children of a board should be searched in parallel. The top
+  // root is always split when there is a pool, deeper boards only when they
+  // still have at least split_depth_ moves to look ahead.
+  bool ShouldSplit(const tictactoeai::SearchContext* context,
+                   const tictactoe::TicTacToe &board, bool top_root,
+                   unsigned int move_depth)
+  {
+    if (!context->pool_ || board.get_empty_spaces() < 2)
+      return false;
+
+    if (top_root)
+      return true;
+
+    return context->split_depth_ > 0 && move_depth >= context->split_depth_;
+  }
+
+  // Searches one of the younger children of a split point on a worker thread,
+  // on the worker's own copy of the board
+  //
+  // The window is narrowed to the best score found so far. A child that came
+  // before the current best child in the scan order is searched one point
+  // wider so that when it ties it still returns its exact score and is
+  // picked, which makes the chosen child the same as the single threaded
+  // search no matter which child finishes first.
+  //
+  // @param parent the board of the split point
+  // @param cell the cell the child places a token on
+  // @param child the index of the child
+  // @param rank where the child came before the moves were ordered
+  // @param player which players turn it is at the split point
+  // @param move_depth how many moves the split point looks ahead
+  // @param alpha the alpha score the split point was searched with
+  // @param beta the beta score the split point was searched with
+  // @param context the search state of the split point
+  // @param split the shared state of the split point
+  void SearchSplitChild(const tictactoe::TicTacToe* parent, unsigned int cell,
+                        unsigned int child, unsigned int rank, bool player,
+                        unsigned int move_depth, int alpha, int beta,
+                        const tictactoeai::SearchContext* context,
+                        tictactoeai::SplitPoint* split)
+  {
+    if (split->IsCutoff())
+      return;
+
+    int child_alpha = alpha;
+    {
+      std::lock_guard<std::mutex> lock(split->mutex_);
+      int tie = (rank < split->best_rank_) ? 1 : 0;
+
+      child_alpha = std::max(alpha, split->best_score_ - tie);
+    }
+
+    tictactoe::TicTacToe board(*parent);
+    board.PlaceToken(player, cell % board.get_width(),
+                     cell / board.get_width());
+
+    tictactoeai::SearchContext local = *context;
+    local.split_ = split;
+    local.nodes_ = 0;
+
+    // Each task counts into its own stats, they are added to the stats of the
+    // split point under its lock
+    tictactoeai::SearchStats stats;
+    if (context->stats_)
+      local.stats_ = &stats;
+
+    // Starts from what the thread of the split point has learned so far
+    tictactoeai::MoveOrderer orderer(*context->orderer_);
+    local.orderer_ = &orderer;
+
+    int score = SearchMove(board, player, move_depth - 1, child_alpha, beta,
+                           true, &local);
+
+    if (local.progress_)
+      local.progress_->nodes_.fetch_add(local.nodes_);
+
+    std::lock_guard<std::mutex> lock(split->mutex_);
+
+    if (context->stats_)
+      context->stats_->Merge(stats);
+
+    if (split->IsCutoff())
+      return;
+
+    bool better = score > split->best_score_;
+    bool earlier_tie = score == split->best_score_ &&
+                       rank < split->best_rank_ && score > child_alpha;
+
+    if (better || earlier_tie)
+    {
+      split->best_score_ = score;
+      split->best_child_ = child;
+      split->best_rank_ = rank;
+    }
+
+    if (split->best_score_ >= beta)
+    {
+      split->cutoff_ = true;
+      RecordCutoff(context, move_depth, child);
+    }
+  }
+
+  // Searches a board using young brothers wait: the eldest child is searched
+  // first to get a bound, then the rest of the children are searched in
+  // parallel on the pool with that bound
+  //
+  // @param board the board to search, left unchanged
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param move_depth how many moves to look ahead
+  // @param alpha the alpha score for alpha beta pruning
+  // @param beta the beta score for alpha beta pruning
+  // @param context the search state
+  // @param best_move set to the cell of the best move when not NULL, only
+  //  the top root asks for it
+  // @param hash_move the cell to try first, -1 for none
+  //
+  // @return the score of the board from the view of the player to move
+  int SearchSplitPoint(tictactoe::TicTacToe &board, bool player,
+                       unsigned int move_depth, int alpha, int beta,
+                       tictactoeai::SearchContext* context, int* best_move,
+                       int hash_move)
+  {
+    unsigned short moves[tictactoe::kMaxCells];
+    unsigned short ranks[tictactoe::kMaxCells];
+    unsigned int count = GenerateMoves(
+        board, best_move ? context->root_first_move_ : -1, context->symmetry_,
+        moves);
+    OrderMoves(context, board, player, move_depth, hash_move, moves, count,
+               ranks);
+    unsigned int width = board.get_width();
+    RecordExpanded(context);
+
+    board.PlaceToken(player, moves[0] % width, moves[0] / width);
+    int eldest_score = SearchMove(board, player, move_depth - 1, alpha, beta,
+                                  false, context);
+    board.RemoveToken(moves[0] % width, moves[0] / width);
+
+    if (IsAborted(context))
+      return 0;
+
+    tictactoeai::SplitPoint split;
+    split.parent_ = context->split_;
+    split.best_score_ = eldest_score;
+    split.best_rank_ = ranks[0];
+
+    if (split.best_score_ >= beta)
+      RecordCutoff(context, move_depth, 0);
+    else
+    {
+      const tictactoe::TicTacToe* parent = &board;
+      tictactoeai::TaskGroup group;
+
+      for (unsigned int i = 1; i < count; ++i)
+      {
+        unsigned int cell = moves[i];
+        unsigned int rank = ranks[i];
+        context->pool_->Submit(&group, [=, &split]() {
+          SearchSplitChild(parent, cell, i, rank, player, move_depth, alpha,
+                           beta, context, &split);
+        });
+      }
+      context->pool_->Wait(&group);
+    }
+
+    if (IsAborted(context))
+      return 0;
+
+    if (split.best_score_ >= beta)
+      UpdateOrdering(context, player, move_depth, moves[split.best_child_]);
+
+    StoreInTable(context, board, player, move_depth, alpha, beta,
+                 split.best_score_, moves[split.best_child_]);
+
+    if (best_move)
+      *best_move = moves[split.best_child_];
+
+    return split.best_score_;
+  }
+
+  // Answers a standard 3x3 board from the solved table without searching
+  //
+  // @param board current tic-tac-toe board
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param result set to the best move, a win or tie score and a depth of
+  //  the empty spaces, with no nodes searched
+  //
+  // @return whether the table had a move for the board
+  bool ChoosePerfectPlacement(const tictactoe::TicTacToe &board, bool player,
+                              tictactoeai::SearchResult* result)
+  {
+    if (!tictactoeai::PerfectPlayTable::IsStandardBoard(board))
+      return false;
+
+    const tictactoeai::PerfectPlayTable& table =
+     tictactoeai::PerfectPlayTable::Get();
+    tictactoeai::SearchResult perfect;
+    perfect.placement_ = table.LookupBestMove(board, player);
+    if (perfect.placement_.first == 100)
+      return false;
+
+    char winner = table.LookupWinner(board, player);
+    if (winner != ' ')
+      perfect.score_ = (winner == 'X' ? 1 : -1) *
+                       tictactoeai::CalcWinScore(board);
+    perfect.depth_ = board.get_empty_spaces();
+
+    *result = perfect;
+    return true;
+  }
+}
+
+//  Construct a Node object for the game decision tree
+//  
+//  @param board the tic-tac-toe board to copy and make moves on
+//  @param placement the position of the last token placed
+tictactoeai::Node::Node(tictactoe::TicTacToe *board,
+           std::pair<unsigned int, unsigned int> placement)
+{
+  this->board_data_ = board;
+  this->placement_ = placement;
+  this->child_arr_length_ = 0;
+  // Using -1 to indicate the best move position hasn't been chosen yet
+  this->best_child_ = -1;
+  // Temp game score, using -1337 as a key value
+  this->game_score_ = -1337;
+}
+
+// Calculates the game score of the given board
+// 
+// A positive score indicates that 'X' is winning, and a negative score
+// indicates that 'O' is winning. If the score is 0 the current game state is a
+// tie. 
+// 
+// Points are awarded for having control of a given dirrection without being
+// blocked by the other player. Every line of win_length cells that only one
+// player has tokens in gives that player a point per token, so on a 3x3 board
+// each token scores a point for each of its row, column and diagonals that
+// the other player has not blocked. Points are also awarded for winning the
+// game.
+//
+// This rescans every line of the board, the search uses EvaluateBoard which
+// gives the same score from the counts the board keeps.
+//
+// @param board the board to calculate the game score of
+// 
+// @return the score of the game
+int tictactoeai::CalcGameScore(const tictactoe::TicTacToe &board)
+{
+  const tictactoe::BoardGeometry& geometry = board.get_geometry();
+
+  // Scores for each player
+  int x = 0;
+  int o = 0;
+
+  for (unsigned int line = 0; line < geometry.get_line_count(); ++line)
+  {
+    const tictactoe::Bitboard& mask = geometry.get_line_mask(line);
+    unsigned int x_count = board.get_x_bits().CountCommon(mask);
+    unsigned int o_count = board.get_o_bits().CountCommon(mask);
+
+    if (o_count == 0)
+      x += x_count;
+    if (x_count == 0)
+      o += o_count;
+  }
+
+  // Award the win score if there is a winner
+  std::pair<bool, char> win_data = board.CheckForWin();
+  if (win_data.second == 'X')
+    x += CalcWinScore(board);
+  else if (win_data.second == 'O')
+    o += CalcWinScore(board);
+
+  return x-o;
+}
+
+// Scores the board the same way as CalcGameScore without rescanning it, using
+// the line score the board keeps up to date as tokens are placed. This is the
+// score used at the leaves of the search.
+//
+// @param board the board to score
+//
+// @return the score of the game, positive when 'X' is winning
+int tictactoeai::EvaluateBoard(const tictactoe::TicTacToe &board)
+{
+  int score = board.get_line_score();
+
+  std::pair<bool, char> win_data = board.CheckForWin();
+  if (win_data.second == 'X')
+    score += CalcWinScore(board);
+  else if (win_data.second == 'O')
+    score -= CalcWinScore(board);
+
+  return score;
+}
+
+// Calculates the points awarded for winning a game on the given board
+//
+// The points are always more than the most any player can get from lines, so
+// a win outweighs any position without one. That is 100 points on a 3x3 board.
+//
+// @param board the board to calculate the win score for
+//
+// @return the points for a win
+int tictactoeai::CalcWinScore(const tictactoe::TicTacToe &board)
+{
+  const tictactoe::BoardGeometry& geometry = board.get_geometry();
+
+  return std::max(100, int(geometry.get_line_count() *
+                           geometry.get_win_length()) + 1);
+}
+
+namespace
+{
+  // Checks if every line in the given dirrection through the given position
+  // has a token in it that does not match the token at the position
+  //
+  // @param board the tictactoe board
+  // @param x the column position
+  // @param y the row position
+  // @param direction the dirrection of the lines to check
+  //
+  // @return whether the dirrection is blocked, true when no line in the
+  //  dirrection goes through the position
+  bool IsDirectionBlocked(const tictactoe::TicTacToe &board,
+                          unsigned int x, unsigned int y,
+                          tictactoe::BoardGeometry::Direction direction)
+  {
+    const tictactoe::BoardGeometry& geometry = board.get_geometry();
+    unsigned int cell = y * board.get_width() + x;
+    char piece = board.GetCell(x, y);
+
+    for (const unsigned short* line = geometry.get_cell_lines_begin(cell);
+         line != geometry.get_cell_lines_end(cell); ++line)
+    {
+      if (geometry.get_line_direction(*line) != direction)
+        continue;
+
+      const tictactoe::Bitboard& mask = geometry.get_line_mask(*line);
+      bool blocked_by_x = piece != 'X' && board.get_x_bits().Intersects(mask);
+      bool blocked_by_o = piece != 'O' && board.get_o_bits().Intersects(mask);
+
+      if (!blocked_by_x && !blocked_by_o)
+        return false;
+    }
+
+    return true;
+  }
+}
+
+// Checks if the row is blocked at the given position
+//
+// @param board the tictactoe board
+// @param x the column position
+// @param y the row position
+//
+// @return whether or not the row is blocked
+bool tictactoeai::IsRowBlocked(const tictactoe::TicTacToe &board,
+                               unsigned int x, unsigned int y)
+{
+  return IsDirectionBlocked(board, x, y, tictactoe::BoardGeometry::kRow);
+}
+
+// Checks if the column is blocked at the given position
+//
+// @param board the tictactoe board
+// @param x the column position
+// @param y the row position
+//
+// @return whether or not the column is blocked
+bool tictactoeai::IsColumnBlocked(const tictactoe::TicTacToe &board,
+                                  unsigned int x, unsigned int y)
+{
+  return IsDirectionBlocked(board, x, y, tictactoe::BoardGeometry::kColumn);
+}
+
+// Checks if the right diagnol through the given position is blocked
+//
+// @param board the tictactoe board
+// @param x the column position
+// @param y the row position
+//
+// @return whether the right diagnol on the board is blocked
+bool tictactoeai::IsRightDiagnolBlocked(const tictactoe::TicTacToe &board,
+                                        unsigned int x, unsigned int y)
+{
+  return IsDirectionBlocked(board, x, y,
+                            tictactoe::BoardGeometry::kRightDiagonal);
+}
+
+// Checks if the left diagnol through the given position is blocked
+//
+// @param board the tictactoe board
+// @param x the column position
+// @param y the row position
+//
+// @return whether the left diagnol on the board is blocked
+bool tictactoeai::IsLeftDiagnolBlocked(const tictactoe::TicTacToe &board,
+                                       unsigned int x, unsigned int y)
+{
+  return IsDirectionBlocked(board, x, y,
+                            tictactoe::BoardGeometry::kLeftDiagonal);
+}
+
+// This function makes a choice for placing a token on the board using the idea
+// of the minimax algorithm. It generates moves up the specified move depth or
+// until the game has been completed. After generating moves the minimax
+// algorithm will make a choice on where is the best place to place a token
+// 
+// If a game score is positive that means that 'X' is winning, if the game
+// score is negative then 'O' is winning, and if the score is zero then it is
+// currently a tie.
+//
+// Alpha beta pruning is also implemented to increase the speed of the function
+// To learn more about minimax and alpha beta pruning check out the wikipedia
+// article
+// - https://en.wikipedia.org/wiki/Minimax
+// - https://en.wikipedia.org/wiki/Alpha%E2%80%93beta_pruning
+// 
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param table transposition table to reuse between calls, may be NULL
+std::pair<unsigned int, unsigned int> tictactoeai::MakePlacementChoice(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    TranspositionTable* table)
+{
+  SearchOptions options;
+  options.table_ = table;
+
+  return MakePlacementChoice(board, move_depth, player, options);
+}
+
+// Picks the search to use for a board
+//
+// @param board current tic-tac-toe board
+// @param options the engine asked for
+//
+// @return kEngineMinimax, kEngineMcts or kEngineProof, never kEngineAuto
+tictactoeai::SearchEngine tictactoeai::ChooseEngine(
+    const tictactoe::TicTacToe &board,
+    const SearchOptions &options)
+{
+  if (options.engine_ != kEngineAuto)
+    return options.engine_;
+
+  return board.get_geometry().get_cell_count() > kMctsAutoCells ?
+   kEngineMcts : kEngineMinimax;
+}
+
+// Makes a placement choice with the given search options and reports what
+// the search found, see MakePlacementChoice
+//
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+//
+// @return the placement choice and what the search found, a choice from
+//  the solved table scores a win or a tie and counts no nodes
+tictactoeai::SearchResult tictactoeai::ChoosePlacement(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options)
+{
+  SearchResult book_result;
+  if (options.book_ && options.book_->Lookup(board, player, &book_result) &&
+      book_result.depth_ >= std::min(move_depth, board.get_empty_spaces()))
+    return book_result;
+
+  if (ChooseEngine(board, options) == kEngineMcts)
+    return MakeMctsPlacementChoice(board, player, options);
+
+  // A proof that stops early falls back to alpha beta search
+  SearchResult proof;
+  if (ChooseEngine(board, options) == kEngineProof)
+  {
+    proof = MakeProofPlacementChoice(board, player, options);
+    if (proof.placement_.first != 100)
+      return proof;
+  }
+
+  SearchResult perfect;
+  if (options.perfect_play_ && move_depth >= board.get_empty_spaces() &&
+      ChoosePerfectPlacement(board, player, &perfect))
+    return perfect;
+
+  SearchResult result = AnalyzePlacement(board, move_depth, player, options);
+  result.nodes_ += proof.nodes_;
+  return result;
+}
+
+// Makes a placement choice with the given search options
+//
+// A board in the book of the options searched at least move_depth deep, or
+// a standard 3x3 board searched to the end of the game, is answered without
+// searching. When the options pick Monte Carlo tree search or proof number
+// search the move depth is not used.
+//
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+std::pair<unsigned int, unsigned int> tictactoeai::MakePlacementChoice(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options)
+{
+  return ChoosePlacement(board, move_depth, player, options).placement_;
+}
+
+// Starts a placement choice on a thread of its own, see MakePlacementChoice.
+// Setting options.cancel_ stops the search early, a fixed depth search that
+// is stopped has no placement to give.
+//
+// @param board current tic-tac-toe board, copied for the search
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with, whatever they point
+//  to must outlive the search
+//
+// @return the result of the search once it finishes
+std::future<tictactoeai::SearchResult> tictactoeai::StartPlacementChoice(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options)
+{
+  return std::async(std::launch::async, [board, move_depth, player, options]() {
+    return ChoosePlacement(board, move_depth, player, options);
+  });
+}
+
+// Starts a placement choice within a time limit on a thread of its own, see
+// MakeTimedPlacementChoice. Setting options.cancel_ stops the search early
+// with the result of the deepest search it finished.
+//
+// @param board current tic-tac-toe board, copied for the search
+// @param time_budget how long the search may take, kNoTimeLimit to search
+//  until it is cancelled or reaches the end of every game
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with, whatever they point
+//  to must outlive the search
+//
+// @return the result of the search once it finishes
+std::future<tictactoeai::SearchResult>
+tictactoeai::StartTimedPlacementChoice(
+    const tictactoe::TicTacToe &board,
+    std::chrono::milliseconds time_budget,
+    bool player,
+    const SearchOptions &options)
+{
+  return std::async(std::launch::async, [board, time_budget, player, options]() {
+    return MakeTimedPlacementChoice(board, time_budget, player, options);
+  });
+}
+
+namespace
+{
+  // Runs a search of the given depth from the root of the tree on a copy of
+  // the board
+  //
+  // Given an expected score the search starts with an aspiration window
+  // around it. A score outside of the window is only a bound, so the side of
+  // the window it fell out of is widened and the root searched again until
+  // the score lands inside.
+  //
+  // @param board current tic-tac-toe board
+  // @param move_depth the amount of moves to look ahead
+  // @param player which players turn it is, true for 'X' false for 'O'
+  // @param expected the score the search is expected to find, positive when
+  //  'X' is winning, NULL to search with a full window
+  // @param context the search state
+  // @param result set to the chosen placement, score and depth when the
+  //  search finishes
+  //
+  // @return whether the search finished before it was stopped
+  bool SearchRoot(const tictactoe::TicTacToe &board, unsigned int move_depth,
+                  bool player, const int* expected,
+                  tictactoeai::SearchContext* context,
+                  tictactoeai::SearchResult* result)
+  {
+    tictactoe::TicTacToe game(board);
+    int best_move = -1;
+    int score;
+    context->root_depth_ = move_depth;
+
+    // Windows wider than a win are no narrower than no window at all
+    const int max_window = tictactoeai::CalcWinScore(board);
+    int guess = expected ? (player ? *expected : -*expected) : 0;
+    int window = kAspirationWindow;
+    bool aspiration = expected && guess > -max_window && guess < max_window;
+
+    int alpha = aspiration ? guess - window : -kInfinity;
+    int beta = aspiration ? guess + window : kInfinity;
+
+    while (true)
+    {
+      score = tictactoeai::Negamax(game, player, move_depth, alpha, beta,
+                                   context, &best_move);
+
+      if (IsAborted(context) || best_move < 0)
+        return false;
+
+      if (score > alpha && score < beta)
+        break;
+
+      window *= kAspirationGrowth;
+      if (score <= alpha)
+        alpha = window < max_window ? guess - window : -kInfinity;
+      else
+        beta = window < max_window ? guess + window : kInfinity;
+    }
+
+    result->placement_ = {best_move % board.get_width(),
+                          best_move / board.get_width()};
+    result->score_ = player ? score : -score;
+    result->depth_ = move_depth;
+
+    return true;
+  }
+
+  // Adds the time from when it is made until it goes out of scope to the
+  // elapsed time of the stats, when stats are compiled in
+  class ElapsedTimer
+  {
+   public:
+    explicit ElapsedTimer(tictactoeai::SearchStats* stats)
+    {
+#ifdef TICTACTOEAI_SEARCH_STATS
+      stats_ = stats;
+      start_ = std::chrono::steady_clock::now();
+#else
+      (void)stats;
+#endif
+    }
+
+    ~ElapsedTimer()
+    {
+#ifdef TICTACTOEAI_SEARCH_STATS
+      if (stats_)
+        stats_->elapsed_ += std::chrono::steady_clock::now() - start_;
+#endif
+    }
+
+   private:
+#ifdef TICTACTOEAI_SEARCH_STATS
+    tictactoeai::SearchStats* stats_;
+    std::chrono::steady_clock::time_point start_;
+#endif
+  };
+
+  // Sets up the context for a search with the given options
+  //
+  // @param options the options of the search
+  // @param progress the shared node count and deadline of the search
+  // @param pool set to a pool started for this search when one is needed
+  // @param orderer the move ordering of the calling thread
+  // @param context the context to set up
+  void SetUpContext(const tictactoeai::SearchOptions &options,
+                    tictactoeai::SearchProgress* progress,
+                    std::unique_ptr<tictactoeai::WorkStealingPool>* pool,
+                    tictactoeai::MoveOrderer* orderer,
+                    tictactoeai::SearchContext* context)
+  {
+    context->orderer_ = orderer;
+    context->table_ = options.table_;
+    context->split_depth_ = options.split_depth_;
+    context->symmetry_ = options.symmetry_;
+    context->stats_ = options.stats_;
+    context->progress_ = progress;
+
+    // The calling thread searches too, so one less worker is needed
+    if (options.pool_)
+      context->pool_ = options.pool_;
+    else if (options.threads_ > 1)
+    {
+      pool->reset(new tictactoeai::WorkStealingPool(options.threads_ - 1));
+      context->pool_ = pool->get();
+    }
+  }
+}
+
+// Searches to a fixed depth and reports the placement choice along with its
+// score and the number of nodes searched
+//
+// The search plays and takes back moves on a single board for each thread,
+// so it only needs memory for the moves along the current line of play.
+//
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+//
+// @return the placement choice and what the search found
+tictactoeai::SearchResult tictactoeai::AnalyzePlacement(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options)
+{
+  ElapsedTimer timer(options.stats_);
+  SearchProgress progress;
+  std::unique_ptr<WorkStealingPool> pool;
+  MoveOrderer orderer(options.move_ordering_);
+  SearchContext context;
+  SetUpContext(options, &progress, &pool, &orderer, &context);
+  progress.cancel_ = options.cancel_;
+
+  SearchResult result;
+  SearchRoot(board, move_depth, player, NULL, &context, &result);
+  result.nodes_ = context.nodes_ + progress.nodes_;
+
+  return result;
+}
+
+// Makes a placement choice within a time budget using iterative deepening
+//
+// Searches one move deep, then two, and so on, trying the best placement of
+// the last search first each time so the next search cuts off sooner. When
+// the deadline passes the unfinished search is thrown away and the result of
+// the deepest finished search is returned. The first search is always
+// finished so there is always a placement to return. Deepening stops early
+// once the search reaches the end of every game. Each search from the third
+// on starts with an aspiration window around the score of the search two
+// moves shallower.
+//
+// A board in the book of the options is answered from it without
+// searching when the entry looked to the end of the game, and a standard 3x3
+// board is answered from the solved table. When the options pick Monte
+// Carlo tree search it plays out for the whole time budget instead, and
+// proof number search spends up to half of the time budget proving the
+// board before deepening with what is left. Setting options.cancel_ stops
+// the search the same way the deadline does.
+//
+// @param board current tic-tac-toe board
+// @param time_budget how long the search may take, kNoTimeLimit to search
+//  until it is cancelled or reaches the end of every game
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+//
+// @return the placement choice, its score, the depth reached and the number
+//  of nodes searched over every depth
+tictactoeai::SearchResult tictactoeai::MakeTimedPlacementChoice(
+    const tictactoe::TicTacToe &board,
+    std::chrono::milliseconds time_budget,
+    bool player,
+    const SearchOptions &options)
+{
+  SearchResult book_result;
+  if (options.book_ && options.book_->Lookup(board, player, &book_result) &&
+      book_result.depth_ >= board.get_empty_spaces())
+    return book_result;
+
+  // The table already holds what a search to the end of the game finds
+  SearchResult perfect;
+  if (options.perfect_play_ && ChoosePerfectPlacement(board, player, &perfect))
+    return perfect;
+
+  if (ChooseEngine(board, options) == kEngineMcts)
+  {
+    SearchOptions mcts_options = options;
+    mcts_options.mcts_iterations_ = 0;
+
+    return MakeMctsPlacementChoice(board, player, mcts_options, time_budget);
+  }
+
+  // A proof that runs out of its half of the time leaves the rest of the
+  // budget to iterative deepening
+  SearchResult proof;
+  if (ChooseEngine(board, options) == kEngineProof)
+  {
+    std::chrono::steady_clock::time_point start =
+     std::chrono::steady_clock::now();
+    proof = MakeProofPlacementChoice(
+        board, player, options,
+        time_budget == kNoTimeLimit ? time_budget :
+        std::max(std::chrono::milliseconds(1), time_budget / 2));
+    if (proof.placement_.first != 100)
+      return proof;
+
+    if (time_budget != kNoTimeLimit)
+      time_budget = std::max(std::chrono::milliseconds(0), time_budget -
+          std::chrono::duration_cast<std::chrono::milliseconds>(
+              std::chrono::steady_clock::now() - start));
+  }
+
+  ElapsedTimer timer(options.stats_);
+  SearchProgress progress;
+  std::unique_ptr<WorkStealingPool> pool;
+  MoveOrderer orderer(options.move_ordering_);
+  SearchContext context;
+  SetUpContext(options, &progress, &pool, &orderer, &context);
+
+  SearchResult result;
+  unsigned int max_depth = board.get_empty_spaces();
+
+  // Score of the last search with an odd and with an even depth
+  int scores[2] = {0, 0};
+
+  for (unsigned int depth = 1; depth <= max_depth; ++depth)
+  {
+    // The first search always finishes, the clock and cancel_ only count
+    // from the second on
+    if (depth == 2)
+    {
+      if (time_budget != kNoTimeLimit)
+      {
+        progress.deadline_ = std::chrono::steady_clock::now() + time_budget;
+        progress.has_deadline_ = true;
+      }
+      progress.cancel_ = options.cancel_;
+    }
+
+    if (depth > 1 && ((progress.has_deadline_ &&
+                       std::chrono::steady_clock::now() >= progress.deadline_) ||
+                      (progress.cancel_ && progress.cancel_->load())))
+      break;
+
+    if (result.depth_ > 0)
+      context.root_first_move_ = result.placement_.second * board.get_width() +
+                                 result.placement_.first;
+
+    // The score swings towards whoever places the last token, so the search
+    // two moves shallower, where the same player does, is the better guess
+    const int* expected = depth > 2 ? &scores[depth % 2] : NULL;
+
+    if (!SearchRoot(board, depth, player, expected, &context, &result))
+      break;
+
+    scores[depth % 2] = result.score_;
+  }
+
+  result.nodes_ = context.nodes_ + progress.nodes_ + proof.nodes_;
+
+  return result;
+}
+
+// Builds a node for every placement with the exact score of that placement,
+// for callers that want to see how each move compares. Each placement is
+// searched with a full window so none of the scores are just bounds.
+//
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+// @param arena the arena to build the nodes in, they stay valid until the
+//  arena is reset
+//
+// @return the root node, its children are the placements in search order and
+//  best_child_ is the index of the best one
+tictactoeai::Node* tictactoeai::AnalyzeMoves(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options,
+    SearchArena* arena)
+{
+  SearchProgress progress;
+  std::unique_ptr<WorkStealingPool> pool;
+  MoveOrderer orderer(options.move_ordering_);
+  SearchContext context;
+  SetUpContext(options, &progress, &pool, &orderer, &context);
+
+  Node* root = arena->Create<Node>(
+      arena->Create<tictactoe::TicTacToe>(board), std::make_pair(100u, 100u));
+
+  if (move_depth == 0 || board.IsGameOver().first)
+  {
+    root->game_score_ = EvaluateBoard(board);
+    return root;
+  }
+
+  unsigned short moves[tictactoe::kMaxCells];
+  unsigned int move_count = GenerateMoves(board, -1, false, moves);
+
+  root->child_arr_length_ = move_count;
+  root->children_ = arena->CreateArray<Node*>(move_count);
+
+  for (unsigned int child = 0; child < move_count; ++child)
+  {
+    unsigned int i = moves[child] % board.get_width();
+    unsigned int j = moves[child] / board.get_width();
+
+    tictactoe::TicTacToe* copy = arena->Create<tictactoe::TicTacToe>(board);
+    copy->PlaceToken(player, i, j);
+
+    tictactoe::TicTacToe game(*copy);
+    Node* node = arena->Create<Node>(copy, std::make_pair(i, j));
+    int score = -Negamax(game, !player, move_depth - 1, -kInfinity, kInfinity,
+                         &context);
+    node->game_score_ = player ? score : -score;
+    root->children_[child] = node;
+
+    if (root->best_child_ < 0 ||
+        (player ? node->game_score_ > root->game_score_
+                : node->game_score_ < root->game_score_))
+    {
+      root->best_child_ = child;
+      root->game_score_ = node->game_score_;
+    }
+  }
+
+  return root;
+}
+
+// Builds the principal variation, the line of play where both players make
+// the placement choice at every move, as a chain of nodes
+//
+// @param board current tic-tac-toe board
+// @param move_depth the amount of moves to look ahead
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param options the table and threads to search with
+// @param arena the arena to build the nodes in, they stay valid until the
+//  arena is reset
+//
+// @return the root node, each node has the next placement as its only child
+//  and the score of the line as its game score
+tictactoeai::Node* tictactoeai::BuildPrincipalVariation(
+    const tictactoe::TicTacToe &board,
+    unsigned int move_depth,
+    bool player,
+    const SearchOptions &options,
+    SearchArena* arena)
+{
+  Node* root = arena->Create<Node>(
+      arena->Create<tictactoe::TicTacToe>(board), std::make_pair(100u, 100u));
+  root->game_score_ = EvaluateBoard(board);
+
+  Node* node = root;
+  for (unsigned int depth = move_depth; depth > 0; --depth)
+  {
+    SearchResult result = AnalyzePlacement(*node->board_data_, depth, player,
+                                           options);
+    if (result.depth_ == 0)
+      break;
+
+    node->game_score_ = result.score_;
+
+    tictactoe::TicTacToe* next =
+     arena->Create<tictactoe::TicTacToe>(*node->board_data_);
+    next->PlaceToken(player, result.placement_.first,
+                     result.placement_.second);
+
+    Node* child = arena->Create<Node>(next, result.placement_);
+    child->game_score_ = EvaluateBoard(*next);
+
+    node->child_arr_length_ = 1;
+    node->children_ = arena->CreateArray<Node*>(1);
+    node->children_[0] = child;
+    node->best_child_ = 0;
+
+    node = child;
+    player = !player;
+  }
+
+  return root;
+}
+
+// Figures out the best game score the player to move can get from the board
+//
+// Both players are searched by the same code by always scoring the board from
+// the view of the player to move, a score for one player is the negative of
+// the score for the other. To learn more check out the wikipedia article
+// - https://en.wikipedia.org/wiki/Negamax
+//
+// Implements alpha beta pruning in order to optimize the function, with
+// principal variation search: once the first move has been searched the rest
+// are only checked to be worse than it with a null window, and searched
+// properly when they are not. Moves are played and taken back on the given
+// board instead of copying it for every child. When the context has a thread
+// pool the children may be searched in parallel.
+//
+// @param board the board to search, it is left as it was given
+// @param player which players turn it is, true for 'X' false for 'O'
+// @param move_depth how many moves to look ahead
+// @param alpha the alpha score for alpha beta pruning
+// @param beta the beta score for the alpha beta pruning
+// @param context the table and thread pool for the search
+// @param best_move set to the cell of the best move when not NULL, only the
+//  top root of the search asks for it
+//
+// @return the best score, positive when the player to move is winning
+int tictactoeai::Negamax(tictactoe::TicTacToe &board, bool player,
+                         unsigned int move_depth, int alpha, int beta,
+                         SearchContext* context, int* best_move)
+{
+  if (IsAborted(context))
+    return 0;
+
+  CountNode(context);
+  RecordNode(context, move_depth);
+
+  // Checks if no more moves can be made
+  if (move_depth == 0 || board.IsGameOver().first)
+  {
+    RecordLeaf(context);
+    return player ? EvaluateBoard(board) : -EvaluateBoard(board);
+  }
+
+  // The top root always searches so it has a move to return
+  const bool top_root = best_move != NULL;
+  int score;
+
+  int hash_move = top_root ? context->root_first_move_ : -1;
+
+  if (!top_root && ProbeTable(context, board, player, move_depth,
+                              alpha, beta, &score, &hash_move))
+    return score;
+
+  if (ShouldSplit(context, board, top_root, move_depth))
+    return SearchSplitPoint(board, player, move_depth, alpha, beta, context,
+                            best_move, hash_move);
+
+  const int alpha_start = alpha;
+  RecordExpanded(context);
+
+  unsigned short moves[tictactoe::kMaxCells];
+  unsigned short ranks[tictactoe::kMaxCells];
+  unsigned int move_count = GenerateMoves(
+      board, top_root ? context->root_first_move_ : -1, context->symmetry_,
+      moves);
+  OrderMoves(context, board, player, move_depth, hash_move, moves,
+             move_count, top_root ? ranks : NULL);
+
+  // Ties at the top root go to the move that came first in the scan order,
+  // so the ordering never changes which move is chosen
+  int max = INT32_MIN;
+  unsigned short max_move = moves[0];
+  unsigned int max_rank = 0;
+
+  for (unsigned int child = 0; child < move_count; ++child)
+  {
+    unsigned int i = moves[child] % board.get_width();
+    unsigned int j = moves[child] / board.get_width();
+
+    // A move that came earlier in the scan order than the best move is
+    // searched one point wider so a tie still gets its exact score
+    bool earlier = top_root && child > 0 && ranks[child] < max_rank;
+    int child_alpha = (earlier && alpha > -kInfinity) ? alpha - 1 : alpha;
+
+    board.PlaceToken(player, i, j);
+    score = SearchMove(board, player, move_depth - 1, child_alpha, beta,
+                       child > 0, context);
+    board.RemoveToken(i, j);
+
+    if (IsAborted(context))
+      return 0;
+
+    if (score > max || (earlier && score == max && score > child_alpha))
+    {
+      max = score;
+      max_move = moves[child];
+      max_rank = top_root ? ranks[child] : 0;
+    }
+
+    if (max > alpha)
+      alpha = max;
+
+    if (beta <= alpha)
+    {
+      RecordCutoff(context, move_depth, child);
+      UpdateOrdering(context, player, move_depth, moves[child]);
+      break;
+    }
+  }
+
+  StoreInTable(context, board, player, move_depth, alpha_start, beta, max,
+               max_move);
+
+  if (best_move)
+    *best_move = max_move;
+
+  return max;
+}
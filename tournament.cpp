@@ -0,0 +1,289 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "perfect_play_table.h"
+#include "tictactoe_ai.h"
+#include "tournament.h"
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * File for playing tournaments of the a.i. against itself
+ *
+ * Games are handed out to worker threads one at a time. Game 2n and game
+ * 2n + 1 open with the same random moves, the first side plays 'X' in the
+ * even games and 'O' in the odd ones. The report looks like:
+ *
+ *   tournament games=1000 seconds=2.1 games_per_sec=476.2
+ *   side=a wins=0 draws=1000 losses=0 ms_per_move=0.42 nodes_per_move=611
+ *    blunders=0 illegal=0
+ *
+ * with the side lines on one line each. Wins, draws and losses of side a are
+ * the losses, draws and wins of side b.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // How a player stands with perfect play, 2 for a win, 1 for a tie and 0
+  // for a loss
+  //
+  // @param winner who wins with perfect play, 'X', 'O' or ' ' for a tie
+  // @param player true for 'X' false for 'O'
+  //
+  // @return the standing of the player
+  int Standing(char winner, bool player)
+  {
+    if (winner == ' ')
+      return 1;
+
+    return (winner == 'X') == player ? 2 : 0;
+  }
+
+  // Plays random moves to open a game, the same for every game with the
+  // same seed and pair of games
+  //
+  // @param board the empty board to open
+  // @param settings the number of moves and the seed
+  // @param pair the pair of games the opening is for
+  //
+  // @return which players turn it is after the opening, true for 'X' false
+  //  for 'O'
+  bool PlayOpening(tictactoe::TicTacToe* board,
+                   const tictactoeai::TournamentSettings& settings,
+                   uint64_t pair)
+  {
+    std::mt19937_64 random(settings.seed_ * 0x9e3779b97f4a7c15ULL + pair);
+    unsigned int width = board->get_width();
+    bool player = true;
+
+    for (unsigned int i = 0; i < settings.opening_moves_; ++i)
+    {
+      if (board->IsGameOver().first)
+        break;
+
+      std::vector<unsigned int> empty;
+      for (unsigned int cell = 0;
+           cell < board->get_geometry().get_cell_count(); ++cell)
+        if (board->GetCell(cell % width, cell / width) == ' ')
+          empty.push_back(cell);
+
+      unsigned int cell = empty[random() % empty.size()];
+      board->PlaceToken(player, cell % width, cell / width);
+      player = !player;
+    }
+
+    return player;
+  }
+
+  // Plays one game of a tournament to the end
+  //
+  // @param settings the tournament settings
+  // @param game the number of the game
+  // @param tables the transposition table of each side
+  // @param reports the report of each side the game is added to
+  void PlayGame(const tictactoeai::TournamentSettings& settings,
+                uint64_t game, tictactoeai::TranspositionTable* tables,
+                tictactoeai::SideReport* reports)
+  {
+    tictactoe::TicTacToe board(settings.width_, settings.height_,
+                               settings.win_length_);
+    bool player = PlayOpening(&board, settings, game / 2);
+
+    // Which side plays 'X'
+    unsigned int x_side = game % 2;
+
+    const tictactoeai::PerfectPlayTable* solved = NULL;
+    if (tictactoeai::PerfectPlayTable::IsStandardBoard(board))
+      solved = &tictactoeai::PerfectPlayTable::Get();
+
+    // Side that made an illegal move, 2 for neither
+    unsigned int forfeit = 2;
+
+    while (!board.IsGameOver().first)
+    {
+      unsigned int side = player ? x_side : 1 - x_side;
+      const tictactoeai::SideSettings& side_settings = settings.sides_[side];
+      tictactoeai::SideReport& report = reports[side];
+
+      tictactoeai::SearchOptions options;
+      options.table_ = &tables[side];
+      options.engine_ = side_settings.engine_;
+      options.mcts_iterations_ = side_settings.mcts_iterations_;
+      options.mcts_seed_ = settings.seed_ + game * 1000 +
+                           board.get_empty_spaces();
+      options.perfect_play_ = side_settings.perfect_play_;
+
+      std::chrono::steady_clock::time_point start =
+       std::chrono::steady_clock::now();
+      tictactoeai::SearchResult result;
+      if (side_settings.time_budget_.count() > 0)
+        result = tictactoeai::MakeTimedPlacementChoice(
+            board, side_settings.time_budget_, player, options);
+      else
+        result = tictactoeai::ChoosePlacement(
+            board, side_settings.move_depth_, player, options);
+      report.time_ += std::chrono::steady_clock::now() - start;
+
+      ++report.moves_;
+      report.nodes_ += result.nodes_;
+
+      unsigned int x = result.placement_.first;
+      unsigned int y = result.placement_.second;
+      if (x >= board.get_width() || y >= board.get_height() ||
+          board.GetCell(x, y) != ' ')
+      {
+        ++report.illegal_moves_;
+        forfeit = side;
+        break;
+      }
+
+      char before = solved ? solved->LookupWinner(board, player) : '?';
+      board.PlaceToken(player, x, y);
+      char after = solved ? solved->LookupWinner(board, !player) : '?';
+
+      if (before != '?' && after != '?' &&
+          Standing(after, player) < Standing(before, player))
+        ++report.blunders_;
+
+      player = !player;
+    }
+
+    // Which side won, 2 for a tie
+    unsigned int winner = 2;
+    if (forfeit != 2)
+      winner = 1 - forfeit;
+    else
+    {
+      char winning_token = board.IsGameOver().second;
+      if (winning_token != ' ')
+        winner = (winning_token == 'X') ? x_side : 1 - x_side;
+    }
+
+    if (winner == 2)
+    {
+      ++reports[0].draws_;
+      ++reports[1].draws_;
+    }
+    else
+    {
+      ++reports[winner].wins_;
+      ++reports[1 - winner].losses_;
+    }
+  }
+
+  // Adds the counts of one side report to another
+  void AddReport(const tictactoeai::SideReport& from,
+                 tictactoeai::SideReport* to)
+  {
+    to->wins_ += from.wins_;
+    to->draws_ += from.draws_;
+    to->losses_ += from.losses_;
+    to->moves_ += from.moves_;
+    to->nodes_ += from.nodes_;
+    to->time_ += from.time_;
+    to->blunders_ += from.blunders_;
+    to->illegal_moves_ += from.illegal_moves_;
+  }
+}
+
+// Plays every game of a tournament between the two sides of the settings
+//
+// Each worker thread takes the next game not yet started and plays it to
+// the end, searching on its own thread. With fixed depths and iterations the
+// same settings always give the same results however many threads play
+// them, so a change that only makes the a.i. faster must not change the
+// wins, draws, losses or blunders.
+//
+// @param settings the board, the sides, the games and the threads
+//
+// @return the results of both sides and how long the games took
+tictactoeai::TournamentReport tictactoeai::RunTournament(
+    const TournamentSettings& settings)
+{
+  // Throws here for a bad size instead of in every worker
+  tictactoe::BoardGeometry::Get(settings.width_, settings.height_,
+                                settings.win_length_);
+
+  unsigned int threads = settings.threads_;
+  if (threads == 0)
+    threads = std::max(1u, std::thread::hardware_concurrency());
+
+  TranspositionTable tables[2];
+  tables[0].Resize(settings.table_megabytes_);
+  tables[1].Resize(settings.table_megabytes_);
+
+  TournamentReport report;
+  std::mutex report_mutex;
+  std::atomic<uint64_t> next_game(0);
+
+  std::chrono::steady_clock::time_point start =
+   std::chrono::steady_clock::now();
+
+  std::vector<std::thread> workers;
+  for (unsigned int i = 0; i < threads; ++i)
+  {
+    workers.emplace_back([&]() {
+      SideReport sides[2];
+
+      for (uint64_t game = next_game++; game < settings.games_;
+           game = next_game++)
+        PlayGame(settings, game, tables, sides);
+
+      std::lock_guard<std::mutex> lock(report_mutex);
+      AddReport(sides[0], &report.sides_[0]);
+      AddReport(sides[1], &report.sides_[1]);
+    });
+  }
+
+  for (unsigned int i = 0; i < workers.size(); ++i)
+    workers[i].join();
+
+  report.games_ = settings.games_;
+  report.seconds_ = std::chrono::duration<double>(
+      std::chrono::steady_clock::now() - start).count();
+  return report;
+}
+
+// Writes a report as key=value pairs, first a line for the whole tournament
+// and then a line for each side
+//
+// @param report the report to write
+// @param output where to write it
+void tictactoeai::PrintTournamentReport(const TournamentReport& report,
+                                        std::ostream& output)
+{
+  output << "tournament games=" << report.games_ <<
+   " seconds=" << report.seconds_ <<
+   " games_per_sec=" << report.games_ / std::max(report.seconds_, 1e-9) <<
+   '\n';
+
+  for (unsigned int i = 0; i < 2; ++i)
+  {
+    const SideReport& side = report.sides_[i];
+    uint64_t moves = std::max<uint64_t>(side.moves_, 1);
+
+    output << "side=" << char('a' + i) <<
+     " wins=" << side.wins_ <<
+     " draws=" << side.draws_ <<
+     " losses=" << side.losses_ <<
+     " ms_per_move=" <<
+     std::chrono::duration<double, std::milli>(side.time_).count() / moves <<
+     " nodes_per_move=" << side.nodes_ / moves <<
+     " blunders=" << side.blunders_ <<
+     " illegal=" << side.illegal_moves_ << '\n';
+  }
+
+  output.flush();
+}
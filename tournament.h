@@ -0,0 +1,114 @@
+#ifndef TOURNAMENT_H_
+#define TOURNAMENT_H_
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+
+#include "tictactoe_ai.h"
+
+/******************************************************************************
+ *
+ * Plays the a.i. against itself, many games at once, to measure how fast it
+ * plays and check that it still plays as well
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // How one side of a tournament chooses its moves
+  class SideSettings
+  {
+   public:
+    // Moves to look ahead, used when there is no time budget
+    unsigned int move_depth_ = 9;
+
+    // Time to choose each move with iterative deepening, 0 to search to
+    // move_depth_ instead
+    std::chrono::milliseconds time_budget_{0};
+
+    // Search to use, with kEngineMcts each move gets mcts_iterations_
+    // playouts unless there is a time budget
+    SearchEngine engine_ = kEngineMinimax;
+    unsigned int mcts_iterations_ = 10000;
+
+    // Answer full depth choices on a standard 3x3 board from the solved
+    // table, off so the search itself gets played
+    bool perfect_play_ = false;
+  };
+
+  // Settings for a tournament between two sides
+  class TournamentSettings
+  {
+   public:
+    // Size of the board every game is played on
+    unsigned int width_ = 3;
+    unsigned int height_ = 3;
+    unsigned int win_length_ = 3;
+
+    // The sides take turns playing 'X', and both games of each pair start
+    // from the same opening so neither side gets the better ones
+    SideSettings sides_[2];
+
+    unsigned int games_ = 1000;
+
+    // Random moves played to open each game before the sides take over,
+    // chosen from the seed so the same settings play the same openings
+    unsigned int opening_moves_ = 2;
+    uint64_t seed_ = 1;
+
+    // Number of games played at once, 0 for one per core
+    unsigned int threads_ = 0;
+
+    // Memory of the transposition table of each side, the games being
+    // played at once share the two tables
+    size_t table_megabytes_ = 16;
+  };
+
+  // What one side did over a tournament
+  class SideReport
+  {
+   public:
+    uint64_t wins_ = 0;
+    uint64_t draws_ = 0;
+    uint64_t losses_ = 0;
+
+    // Moves the side chose, the nodes it searched for them and the time it
+    // took to choose them
+    uint64_t moves_ = 0;
+    uint64_t nodes_ = 0;
+    std::chrono::nanoseconds time_{0};
+
+    // Moves on a standard 3x3 board that left the side worse off with
+    // perfect play than before, a side that searches with the other
+    // player's tokens blunders all the time
+    uint64_t blunders_ = 0;
+
+    // Choices of a cell that is off the board or taken, the side loses the
+    // game on the spot
+    uint64_t illegal_moves_ = 0;
+  };
+
+  // What happened over a tournament
+  class TournamentReport
+  {
+   public:
+    uint64_t games_ = 0;
+    double seconds_ = 0;
+    SideReport sides_[2];
+  };
+
+  // Plays every game of a tournament
+  TournamentReport RunTournament(const TournamentSettings& settings);
+
+  // Writes a report, one line for the tournament and one for each side
+  void PrintTournamentReport(const TournamentReport& report,
+                             std::ostream& output);
+}
+
+#endif  // TOURNAMENT_H_
@@ -0,0 +1,261 @@
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "transposition_table.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the TranspositionTable class
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // An entry is packed into one word, from the lowest bit up: 32 bits of
+  // score, 16 bits of best move, 9 bits of depth, 2 bits of bound plus one so
+  // a used entry is never zero, and 5 bits of generation
+  const unsigned int kMoveShift = 32;
+  const unsigned int kDepthShift = 48;
+  const unsigned int kBoundShift = 57;
+  const unsigned int kGenerationShift = 59;
+  const uint64_t kDepthMask = 0x1ff;
+  const uint64_t kBoundMask = 0x3;
+  const uint64_t kGenerationMask = 0x1f;
+
+  uint64_t PackEntry(int score, unsigned int depth, tictactoeai::BoundType bound,
+                     unsigned short best_move, unsigned int generation)
+  {
+    if (depth > kDepthMask)
+      depth = kDepthMask;
+
+    return uint64_t(uint32_t(score)) |
+           uint64_t(best_move) << kMoveShift |
+           uint64_t(depth) << kDepthShift |
+           uint64_t(bound + 1) << kBoundShift |
+           uint64_t(generation & kGenerationMask) << kGenerationShift;
+  }
+
+  unsigned int GetPackedDepth(uint64_t data)
+  {
+    return (data >> kDepthShift) & kDepthMask;
+  }
+
+  unsigned int GetPackedGeneration(uint64_t data)
+  {
+    return (data >> kGenerationShift) & kGenerationMask;
+  }
+
+  void UnpackEntry(uint64_t key, uint64_t data, tictactoeai::TableEntry* entry)
+  {
+    entry->key_ = key;
+    entry->score_ = int(uint32_t(data));
+    entry->best_move_ = (data >> kMoveShift) & 0xffff;
+    entry->depth_ = GetPackedDepth(data);
+    entry->bound_ = ((data >> kBoundShift) & kBoundMask) - 1;
+    entry->used_ = true;
+  }
+
+  // Hands each new thread the next counter slot
+  std::atomic<unsigned int> next_thread_slot(0);
+}
+
+// Creates an empty transposition table
+//
+// @param size_bits the table holds 2^size_bits entries
+tictactoeai::TranspositionTable::TranspositionTable(unsigned int size_bits)
+    : counters_(new CounterSlot[kCounterThreads])
+{
+  Allocate(size_bits > 0 ? size_t(1) << (size_bits - 1) : 1);
+}
+
+// Builds the table key for a board, the hash of the board is mixed with the
+// player to move so the same tokens searched for X and for O do not collide
+//
+// @param board_hash the zobrist hash of the board
+// @param player which players turn it is, true for 'X' false for 'O'
+//
+// @return the key to probe and store with
+uint64_t tictactoeai::TranspositionTable::MakeKey(uint64_t board_hash,
+                                                  bool player)
+{
+  return player ? board_hash : board_hash ^ 0xd1b54a32d192ed03ULL;
+}
+
+// Gets the counter slot of the calling thread, threads are handed slots in
+// the order they first ask and wrap around past kCounterThreads
+//
+// @return the slot, below kCounterThreads
+unsigned int tictactoeai::TranspositionTable::GetThreadSlot()
+{
+  thread_local unsigned int slot =
+      next_thread_slot.fetch_add(1, std::memory_order_relaxed) %
+      kCounterThreads;
+  return slot;
+}
+
+// Looks up the entry for the given key
+//
+// @param key the position key
+// @param entry set to the stored entry when the key is found
+//
+// @return whether the key was found
+bool tictactoeai::TranspositionTable::Probe(uint64_t key, TableEntry* entry)
+{
+  Bucket& bucket = buckets_[key & mask_];
+  CounterSlot& counters = counters_[GetThreadSlot()];
+
+  for (unsigned int i = 0; i < kBucketSlots; ++i)
+  {
+    uint64_t data = bucket.slots_[i].data_.load(std::memory_order_relaxed);
+    uint64_t check = bucket.slots_[i].check_.load(std::memory_order_relaxed);
+
+    if (data != 0 && (check ^ data) == key)
+    {
+      counters.hits_.fetch_add(1, std::memory_order_relaxed);
+      UnpackEntry(key, data, entry);
+      return true;
+    }
+  }
+
+  counters.misses_.fetch_add(1, std::memory_order_relaxed);
+  return false;
+}
+
+// Stores the result of a search. The first slot of the bucket takes it when
+// it holds the same key, an entry of an older generation or one searched no
+// deeper, otherwise the second slot is replaced.
+//
+// @param key the position key
+// @param score the score found for the position
+// @param depth the depth the position was searched to
+// @param bound whether the score is exact or a bound
+// @param best_move the cell of the best move, kNoMove if there is none
+void tictactoeai::TranspositionTable::Store(uint64_t key, int score,
+                                            unsigned int depth,
+                                            BoundType bound,
+                                            unsigned short best_move)
+{
+  Bucket& bucket = buckets_[key & mask_];
+  CounterSlot& counters = counters_[GetThreadSlot()];
+  unsigned int generation = generation_.load(std::memory_order_relaxed);
+  uint64_t data = PackEntry(score, depth, bound, best_move, generation);
+
+  Slot* slot = &bucket.slots_[0];
+  uint64_t old_data = slot->data_.load(std::memory_order_relaxed);
+  uint64_t old_key = slot->check_.load(std::memory_order_relaxed) ^ old_data;
+
+  if (old_data != 0 && old_key != key &&
+      GetPackedGeneration(old_data) == (generation & kGenerationMask) &&
+      GetPackedDepth(old_data) > GetPackedDepth(data))
+  {
+    slot = &bucket.slots_[1];
+    old_data = slot->data_.load(std::memory_order_relaxed);
+    old_key = slot->check_.load(std::memory_order_relaxed) ^ old_data;
+  }
+
+  counters.stores_.fetch_add(1, std::memory_order_relaxed);
+  if (old_data != 0 && old_key != key)
+    counters.overwrites_.fetch_add(1, std::memory_order_relaxed);
+
+  slot->data_.store(data, std::memory_order_relaxed);
+  slot->check_.store(key ^ data, std::memory_order_relaxed);
+}
+
+// Resizes the table to the most entries that fit in the given memory and
+// empties it. Must not be called while a search is using the table.
+//
+// @param megabytes the memory the table may use, at least one bucket is kept
+void tictactoeai::TranspositionTable::Resize(size_t megabytes)
+{
+  size_t buckets = megabytes * 1024 * 1024 / sizeof(Bucket);
+  size_t bucket_count = 1;
+  while (bucket_count * 2 <= buckets)
+    bucket_count *= 2;
+
+  Allocate(bucket_count);
+}
+
+// Starts a new generation, entries stored before it give way to new ones
+// even when they were searched deeper. Call it between moves of a game so
+// the positions the game has left behind do not fill the table.
+void tictactoeai::TranspositionTable::NewGeneration()
+{
+  generation_.fetch_add(1, std::memory_order_relaxed);
+}
+
+// Removes every entry from the table
+void tictactoeai::TranspositionTable::Clear()
+{
+  for (size_t i = 0; i < bucket_count_; ++i)
+  {
+    for (unsigned int j = 0; j < kBucketSlots; ++j)
+    {
+      buckets_[i].slots_[j].data_.store(0, std::memory_order_relaxed);
+      buckets_[i].slots_[j].check_.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+// Sets the counters of every thread back to zero
+void tictactoeai::TranspositionTable::ResetCounters()
+{
+  for (unsigned int i = 0; i < kCounterThreads; ++i)
+  {
+    counters_[i].hits_.store(0, std::memory_order_relaxed);
+    counters_[i].misses_.store(0, std::memory_order_relaxed);
+    counters_[i].stores_.store(0, std::memory_order_relaxed);
+    counters_[i].overwrites_.store(0, std::memory_order_relaxed);
+  }
+}
+
+// Gets the counters of all threads added together
+//
+// @return the totals
+tictactoeai::TableCounters tictactoeai::TranspositionTable::GetCounters() const
+{
+  TableCounters total;
+  for (unsigned int i = 0; i < kCounterThreads; ++i)
+  {
+    TableCounters counters = GetThreadCounters(i);
+    total.hits_ += counters.hits_;
+    total.misses_ += counters.misses_;
+    total.stores_ += counters.stores_;
+    total.overwrites_ += counters.overwrites_;
+  }
+
+  return total;
+}
+
+// Gets the counters of one thread
+//
+// @param slot the counter slot of the thread, see GetThreadSlot
+//
+// @return the counts of the thread
+tictactoeai::TableCounters
+tictactoeai::TranspositionTable::GetThreadCounters(unsigned int slot) const
+{
+  const CounterSlot& counters = counters_[slot % kCounterThreads];
+
+  TableCounters result;
+  result.hits_ = counters.hits_.load(std::memory_order_relaxed);
+  result.misses_ = counters.misses_.load(std::memory_order_relaxed);
+  result.stores_ = counters.stores_.load(std::memory_order_relaxed);
+  result.overwrites_ = counters.overwrites_.load(std::memory_order_relaxed);
+  return result;
+}
+
+// Replaces the buckets with the given number of empty ones
+//
+// @param bucket_count the number of buckets, a power of two
+void tictactoeai::TranspositionTable::Allocate(size_t bucket_count)
+{
+  buckets_.reset(new Bucket[bucket_count]);
+  bucket_count_ = bucket_count;
+  mask_ = bucket_count - 1;
+}
@@ -0,0 +1,138 @@
+#ifndef TRANSPOSITION_TABLE_H_
+#define TRANSPOSITION_TABLE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/******************************************************************************
+ *
+ * Fixed size cache of searched positions for the tic-tac-toe a.i.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // How the stored score relates to the real score of the position, alpha
+  // beta only gives an exact score when the score was inside the window
+  enum BoundType
+  {
+    kExactBound,
+    kLowerBound,
+    kUpperBound
+  };
+
+  // Value used for best_move_ when no move was recorded
+  const unsigned short kNoMove = 0xffff;
+
+  class TableEntry
+  {
+   public:
+    uint64_t key_ = 0;
+    int score_ = 0;
+    unsigned short depth_ = 0;
+    unsigned char bound_ = kExactBound;
+    // Cell index of the best move found, y * width + x
+    unsigned short best_move_ = kNoMove;
+    bool used_ = false;
+  };
+
+  // Probe and store counts of one thread
+  class TableCounters
+  {
+   public:
+    uint64_t hits_ = 0;
+    uint64_t misses_ = 0;
+    uint64_t stores_ = 0;
+    uint64_t overwrites_ = 0;
+  };
+
+  // Table shared by any number of searches at once without locking. Each slot
+  // keeps its entry packed in one word next to the key xor the entry, so a
+  // slot two threads wrote at the same time no longer matches any key and is
+  // treated as empty.
+  class TranspositionTable
+  {
+   public:
+    // Most threads that get counters of their own, later threads share
+    static const unsigned int kCounterThreads = 64;
+
+    // Creates a table with 2^size_bits entries
+    explicit TranspositionTable(unsigned int size_bits = 16);
+
+    TranspositionTable(const TranspositionTable&) = delete;
+    TranspositionTable& operator=(const TranspositionTable&) = delete;
+
+    // Key for a board hash with the given player to move
+    static uint64_t MakeKey(uint64_t board_hash, bool player);
+
+    // Counter slot of the calling thread
+    static unsigned int GetThreadSlot();
+
+    bool Probe(uint64_t key, TableEntry* entry);
+    void Store(uint64_t key, int score, unsigned int depth, BoundType bound,
+               unsigned short best_move);
+
+    void Resize(size_t megabytes);
+    void NewGeneration();
+    void Clear();
+    void ResetCounters();
+
+    TableCounters GetCounters() const;
+    TableCounters GetThreadCounters(unsigned int slot) const;
+
+    // Get table info
+    size_t get_size() const { return bucket_count_ * kBucketSlots; }
+    size_t get_bytes() const { return bucket_count_ * sizeof(Bucket); }
+    uint64_t get_hits() const { return GetCounters().hits_; }
+    uint64_t get_misses() const { return GetCounters().misses_; }
+    uint64_t get_overwrites() const { return GetCounters().overwrites_; }
+
+   private:
+    static const unsigned int kBucketSlots = 2;
+
+    class Slot
+    {
+     public:
+      std::atomic<uint64_t> check_{0};
+      std::atomic<uint64_t> data_{0};
+    };
+
+    // The first slot keeps the deepest entry of the current generation, the
+    // second takes whatever the first turned away
+    class alignas(32) Bucket
+    {
+     public:
+      Slot slots_[kBucketSlots];
+    };
+
+    // Each thread counts on a cache line of its own so counting costs no
+    // traffic between cores
+    class alignas(64) CounterSlot
+    {
+     public:
+      std::atomic<uint64_t> hits_{0};
+      std::atomic<uint64_t> misses_{0};
+      std::atomic<uint64_t> stores_{0};
+      std::atomic<uint64_t> overwrites_{0};
+    };
+
+    void Allocate(size_t bucket_count);
+
+    std::unique_ptr<Bucket[]> buckets_;
+    size_t bucket_count_ = 0;
+    uint64_t mask_ = 0;
+
+    // Entries stored before the last NewGeneration are replaced first
+    std::atomic<unsigned int> generation_{0};
+
+    std::unique_ptr<CounterSlot[]> counters_;
+  };
+}
+
+#endif  // TRANSPOSITION_TABLE_H_
@@ -0,0 +1,167 @@
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "work_stealing_pool.h"
+
+/******************************************************************************
+ *
+ * File for managing all the methods for the WorkStealingPool class
+ *
+ * Each worker pushes and pops tasks at the back of its own queue, so nested
+ * work stays on one thread, and steals from the front of the other queues
+ * when its own queue is empty.
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace
+{
+  // Which pool the current thread works for and the index of its queue
+  thread_local const tictactoeai::WorkStealingPool* current_pool = NULL;
+  thread_local unsigned int current_queue = 0;
+}
+
+// Starts the worker threads
+//
+// @param threads the number of worker threads to start
+tictactoeai::WorkStealingPool::WorkStealingPool(unsigned int threads)
+{
+  for (unsigned int i = 0; i <= threads; ++i)
+    queues_.emplace_back(new Queue());
+
+  for (unsigned int i = 0; i < threads; ++i)
+    threads_.emplace_back(&WorkStealingPool::WorkerLoop, this, i);
+}
+
+// Stops the worker threads once they finish their current task
+tictactoeai::WorkStealingPool::~WorkStealingPool()
+{
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    stopping_ = true;
+  }
+  wake_.notify_all();
+
+  for (unsigned int i = 0; i < threads_.size(); ++i)
+    threads_[i].join();
+}
+
+// Adds a task to the queue of the calling thread
+//
+// @param group the group the task belongs to
+// @param task the work to run
+void tictactoeai::WorkStealingPool::Submit(TaskGroup* group,
+                                           std::function<void()> task)
+{
+  group->pending_.fetch_add(1);
+
+  // Counted before the push so the count never drops below the real number
+  // of queued tasks
+  {
+    std::lock_guard<std::mutex> lock(sleep_mutex_);
+    queued_.fetch_add(1);
+  }
+
+  Queue& queue = *queues_[CurrentQueue()];
+  {
+    std::lock_guard<std::mutex> lock(queue.mutex_);
+    queue.tasks_.push_back(Task{group, std::move(task)});
+  }
+
+  wake_.notify_one();
+}
+
+// Helps run tasks until every task in the group is done
+//
+// @param group the group to wait for
+void tictactoeai::WorkStealingPool::Wait(TaskGroup* group)
+{
+  unsigned int queue = CurrentQueue();
+
+  while (group->pending_.load() > 0)
+  {
+    if (!RunOne(queue))
+      std::this_thread::yield();
+  }
+}
+
+// Gets the queue the calling thread should use
+//
+// @return the worker's own queue, or the outside queue for other threads
+unsigned int tictactoeai::WorkStealingPool::CurrentQueue() const
+{
+  if (current_pool == this)
+    return current_queue;
+
+  return queues_.size() - 1;
+}
+
+// Runs a single task, taking the newest task from the given queue or stealing
+// the oldest task from another queue
+//
+// @param queue the index of the calling thread's queue
+//
+// @return whether a task was run
+bool tictactoeai::WorkStealingPool::RunOne(unsigned int queue)
+{
+  Task task;
+  bool found = false;
+
+  {
+    Queue& own = *queues_[queue];
+    std::lock_guard<std::mutex> lock(own.mutex_);
+    if (!own.tasks_.empty())
+    {
+      task = std::move(own.tasks_.back());
+      own.tasks_.pop_back();
+      found = true;
+    }
+  }
+
+  for (unsigned int i = 1; !found && i < queues_.size(); ++i)
+  {
+    Queue& victim = *queues_[(queue + i) % queues_.size()];
+    std::lock_guard<std::mutex> lock(victim.mutex_);
+    if (!victim.tasks_.empty())
+    {
+      task = std::move(victim.tasks_.front());
+      victim.tasks_.pop_front();
+      found = true;
+    }
+  }
+
+  if (!found)
+    return false;
+
+  queued_.fetch_sub(1);
+  task.run_();
+  task.group_->pending_.fetch_sub(1);
+
+  return true;
+}
+
+// Main loop of a worker thread, runs tasks and sleeps while there are none
+//
+// @param queue the index of the worker's own queue
+void tictactoeai::WorkStealingPool::WorkerLoop(unsigned int queue)
+{
+  current_pool = this;
+  current_queue = queue;
+
+  while (true)
+  {
+    if (RunOne(queue))
+      continue;
+
+    std::unique_lock<std::mutex> lock(sleep_mutex_);
+    wake_.wait(lock, [this] { return stopping_ || queued_.load() > 0; });
+
+    if (stopping_)
+      return;
+  }
+}
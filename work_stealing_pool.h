@@ -0,0 +1,79 @@
+#ifndef WORK_STEALING_POOL_H_
+#define WORK_STEALING_POOL_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/******************************************************************************
+ *
+ * Thread pool where idle workers steal tasks from busy ones
+ *
+ * Author: Thomas Andrasek
+ *
+ * Last updated: 2026/10/18
+ *
+ * ***************************************************************************/
+
+namespace tictactoeai
+{
+  // Set of tasks that can be waited on together
+  class TaskGroup
+  {
+   public:
+    std::atomic<unsigned int> pending_{0};
+  };
+
+  class WorkStealingPool
+  {
+   public:
+    explicit WorkStealingPool(unsigned int threads);
+    ~WorkStealingPool();
+
+    WorkStealingPool(const WorkStealingPool&) = delete;
+    WorkStealingPool& operator=(const WorkStealingPool&) = delete;
+
+    void Submit(TaskGroup* group, std::function<void()> task);
+
+    // Runs queued tasks on the calling thread until every task in the group
+    // is done, so waiting inside a task never ties up a worker
+    void Wait(TaskGroup* group);
+
+    unsigned int get_thread_count() const { return threads_.size(); }
+
+   private:
+    class Task
+    {
+     public:
+      TaskGroup* group_;
+      std::function<void()> run_;
+    };
+
+    class Queue
+    {
+     public:
+      std::mutex mutex_;
+      std::deque<Task> tasks_;
+    };
+
+    unsigned int CurrentQueue() const;
+    bool RunOne(unsigned int queue);
+    void WorkerLoop(unsigned int queue);
+
+    // One queue per worker, the last queue takes tasks from outside threads
+    std::vector<std::unique_ptr<Queue>> queues_;
+    std::vector<std::thread> threads_;
+
+    std::atomic<bool> stopping_{false};
+    std::atomic<unsigned int> queued_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable wake_;
+  };
+}
+
+#endif  // WORK_STEALING_POOL_H_